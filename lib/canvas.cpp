@@ -3,6 +3,8 @@
  * @file canvas.cpp
  */
 
+#include <algorithm>
+
 #include "canvas.h"
 #include "lodepng.h"
 
@@ -36,7 +38,12 @@ void encode_png(const char* filename, const unsigned char* image, unsigned width
 Canvas::Canvas(const Canvas& clone) {
     m_width = clone.m_width;
     m_height = clone.m_height;
+    m_block_size = clone.m_block_size;
+    m_format = clone.m_format;
     m_pixels = clone.m_pixels;
+    m_board = clone.m_board;
+    m_board_alive = clone.m_board_alive;
+    m_board_bkg = clone.m_board_bkg;
 }
 
 /*!
@@ -48,25 +55,115 @@ Canvas& Canvas::operator=(const Canvas& source) { return *this; }
 /**
  * @brief Clears the canvas by setting all pixels to a specified color.
  *
- * This function iterates over all the pixels in the canvas and sets each one to the given color.
+ * One scanline of the color is built, then copied over every row of blocks.
  *
  * @param color The color to set all the pixels in the canvas to.
  */
 void Canvas::clear(const Color& color) {
-    for (size_t i{ 0 }; i < width(); ++i)
-        for (size_t j{ 0 }; j < height(); ++j)
-            pixel(i, j, color);
+    require_rgba();
+    m_board.clear();
+    vector<uint32_t> scanline(m_width, rgba(color));
+    for (size_t y{ 0 }; y < height(); ++y)
+        fill_block_row(y, scanline.data());
+}
+
+/**
+ * @brief Packs a color into the 4 bytes of an RGBA pixel, fully opaque.
+ *
+ * The bytes are kept in memory order, so the word can be copied straight into m_pixels.
+ *
+ * @param c The color to pack.
+ * @return The pixel as a 32-bit word.
+ */
+uint32_t Canvas::rgba(const Color& c) {
+    const component_t bytes[image_depth] = { c.channels[Color::R], c.channels[Color::G],
+                                             c.channels[Color::B], 255 };
+    uint32_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+/**
+ * @brief Sets or clears a run of pixels in a row of a PALETTE canvas.
+ *
+ * @param row The first byte of the row; its first pixel is the most significant bit.
+ * @param first The first pixel of the run.
+ * @param count How many pixels the run has.
+ * @param value True to set the pixels, false to clear them.
+ */
+void Canvas::fill_bits(component_t* row, size_t first, size_t count, bool value) {
+    size_t last = first + count;
+    while (first < last and first % 8 != 0) {
+        auto mask = static_cast<component_t>(0x80U >> (first % 8));
+        row[first / 8] = value ? (row[first / 8] | mask) : (row[first / 8] & ~mask);
+        ++first;
+    }
+    if (last - first >= 8) {
+        std::memset(row + first / 8, value ? 0xff : 0, (last - first) / 8);
+        first += (last - first) / 8 * 8;
+    }
+    for (; first < last; ++first) {
+        auto mask = static_cast<component_t>(0x80U >> (first % 8));
+        row[first / 8] = value ? (row[first / 8] | mask) : (row[first / 8] & ~mask);
+    }
+}
+
+/**
+ * @brief Throws unless the pixels are RGBA, the only ones the per-pixel methods can draw or read.
+ *
+ * @throw std::logic_error If the canvas is a PALETTE one.
+ */
+void Canvas::require_rgba() const {
+    if (m_format != RGBA)
+        throw std::logic_error("Only draw_board() draws on a palette canvas.");
+}
+
+/**
+ * @brief Copies a scanline over the `block_size` virtual rows of a row of blocks.
+ *
+ * @param y The (real) row of blocks to fill.
+ * @param scanline The row_bytes() bytes of one virtual row.
+ */
+void Canvas::fill_block_row(coord_t y, const void* scanline) {
+    auto first = static_cast<size_t>(y) * m_block_size;
+    for (size_t row = first; row < first + m_block_size and row < m_height; ++row)
+        std::memcpy(&m_pixels[row * row_bytes()], scanline, row_bytes());
+}
+
+/**
+ * @brief Paints the `block_size x block_size` pixels of a block as a live or dead cell.
+ *
+ * @param x The (real) column of the block.
+ * @param y The (real) row of the block.
+ * @param live Whether the cell is alive; the colors are those of the board on the canvas.
+ */
+void Canvas::fill_block(coord_t x, coord_t y, bool live) {
+    auto [virtual_x, virtual_y] = real_to_virtual(x, y);
+    if (m_format == PALETTE) {
+        for (size_t row = virtual_y; row < virtual_y + m_block_size and row < m_height; ++row)
+            fill_bits(&m_pixels[row * row_bytes()], virtual_x, m_block_size, live);
+        return;
+    }
+    uint32_t span[256];
+    auto count = std::min<size_t>(m_block_size, 256);
+    std::fill_n(span, count, live ? m_board_alive : m_board_bkg);
+    for (size_t row = virtual_y; row < virtual_y + m_block_size and row < m_height; ++row)
+        for (size_t col = virtual_x; col < virtual_x + m_block_size; col += count)
+            std::memcpy(&m_pixels[(row * m_width + col) * image_depth], span,
+                        std::min<size_t>(count, virtual_x + m_block_size - col) * image_depth);
 }
 
 /**
  * @brief Retrieves the color of a pixel at the specified coordinates.
  *
  * @throw std::invalid_argument If the pixel coordinate is located outside the canvas.
+ * @throw std::logic_error If the canvas is a PALETTE one.
  * @param x The X coordinate of the pixel we want to know the color of.
  * @param y The Y coordinate of the pixel we want to know the color of.
  * @return The color of the specified pixel.
  */
 Color Canvas::pixel(coord_t x, coord_t y) const {
+    require_rgba();
     if (not in_bounds(x, y))
         throw std::invalid_argument("Invalid pixel coordinate.");
     auto channels = pixel_channels(x, y);
@@ -77,13 +174,16 @@ Color Canvas::pixel(coord_t x, coord_t y) const {
  * @brief Draws a pixel on the real image at the specified coordinates.
  *
  * @note Nothing is done if the pixel coordinate is located outside the canvas.
+ * @throw std::logic_error If the canvas is a PALETTE one.
  * @param x The X coordinate of the pixel to be drawn.
  * @param y The Y coordinate of the pixel to be drawn.
  * @param c The color of the pixel.
  */
 void Canvas::pixel(coord_t x, coord_t y, const Color& c) {
+    require_rgba();
     if (not in_bounds(x, y))
         return;
+    m_board.clear();
     auto [virtual_x, virtual_y] = real_to_virtual(x, y);
     for (int i = 0; i < m_block_size; i++)
         for (int j = 0; j < m_block_size; j++) {
@@ -104,8 +204,9 @@ void Canvas::pixel(coord_t x, coord_t y, const Color& c) {
 /**
  * @brief Converts a matrix to a PNG image and saves it to a specified file path.
  *
- * This function clears the canvas, iterates over the matrix, and draws pixels on the canvas 
- * according to the matrix values. It then encodes the canvas to a PNG image file.
+ * Each row of the matrix is drawn as one scanline of blocks, from colors looked up once,
+ * which is then copied over the `block_size` rows of pixels it covers. Cells other than
+ * 0, 1 and 2 are left black. It then encodes the canvas to a PNG image file.
  *
  * @param matrix The matrix representing the current state of the canvas.
  * @param aliveColor The color used to represent alive cells.
@@ -115,20 +216,136 @@ void Canvas::pixel(coord_t x, coord_t y, const Color& c) {
  * @param genCount The generation count, used in the filename of the PNG image.
  */
 void Canvas::matrix_to_png(std::vector<std::vector<int>>& matrix, std::string aliveColor, std::string bkgColor, std::string imagePath, std::string configPrefix, int genCount){
-    clear();
-    for (int y = 0; y < (int)height(); ++y) {
-        for (int x = 0; x < (int)width(); ++x) {
-            if (matrix[y+1][x+1] == 0 || matrix[y+1][x+1] == 2) {
-                pixel(x, y, color_pallet[bkgColor]);
-            } else if (matrix[y+1][x+1] == 1) {
-                pixel(x, y, color_pallet[aliveColor]);
-            }
+    require_rgba();
+    const uint32_t alive = rgba(color_pallet[aliveColor]);
+    const uint32_t background = rgba(color_pallet[bkgColor]);
+    const uint32_t blank = rgba(BLACK);
+    vector<uint32_t> scanline(m_width);
+    for (size_t y = 0; y < height(); ++y) {
+        const std::vector<int>& cells = matrix[y + 1];
+        for (size_t x = 0; x < width(); ++x) {
+            int cell = cells[x + 1];
+            uint32_t color = (cell == 1) ? alive : (cell == 0 || cell == 2) ? background : blank;
+            std::fill_n(scanline.begin() + x * m_block_size, m_block_size, color);
         }
+        fill_block_row(y, scanline.data());
     }
+    m_board.clear();
     // data.path + / + 
     std::string filename = imagePath + "/" + configPrefix + std::to_string(genCount) + ".png";
-    const char *cstr = filename.c_str();
-    encode_png(cstr, pixels(), virtual_width(), virtual_height());
+    save_png(filename);
+}
+
+/**
+ * @brief Draws a board on the canvas, one block per cell.
+ *
+ * The canvas keeps the board it drew last. When the next one has the same size
+ * and colors, only the blocks of the cells whose bits differ are painted, so the
+ * cost follows the activity of the pattern rather than the size of the image.
+ * Otherwise every row is drawn again as a scanline of blocks. A PALETTE canvas
+ * stores no colors in its pixels, so new colors do not redraw it.
+ *
+ * @param cells The board, width() columns by height() rows, each row padded to whole
+ * 64-bit words; bit j of word k is column 64k + j.
+ * @param alive The color of live cells.
+ * @param bkg The color of dead cells.
+ */
+void Canvas::draw_board(const vector<uint64_t>& cells, const Color& alive, const Color& bkg) {
+    const uint32_t alive_pixel = rgba(alive);
+    const uint32_t bkg_pixel = rgba(bkg);
+    const size_t stride = (width() + 63) / 64;
+    const bool recolored = m_format == RGBA and (m_board_alive != alive_pixel or m_board_bkg != bkg_pixel);
+    m_board_alive = alive_pixel;
+    m_board_bkg = bkg_pixel;
+    if (m_board.size() != cells.size() or recolored) {
+        vector<uint32_t> scanline(m_width);
+        vector<component_t> bits(row_bytes());
+        for (size_t y = 0; y < height(); ++y) {
+            const uint64_t* row = &cells[y * stride];
+            if (m_format == PALETTE) {
+                std::fill(bits.begin(), bits.end(), 0);
+                for (size_t k = 0; k < stride; ++k)
+                    for (uint64_t word = row[k]; word != 0; word &= word - 1) {
+                        size_t x = 64 * k + __builtin_ctzll(word);
+                        if (x < width())
+                            fill_bits(bits.data(), x * m_block_size, m_block_size, true);
+                    }
+                fill_block_row(y, bits.data());
+                continue;
+            }
+            for (size_t x = 0; x < width(); ++x) {
+                bool live = (row[x / 64] >> (x % 64)) & 1U;
+                std::fill_n(scanline.begin() + x * m_block_size, m_block_size, live ? alive_pixel : bkg_pixel);
+            }
+            fill_block_row(y, scanline.data());
+        }
+    } else {
+        for (size_t y = 0; y < height(); ++y) {
+            for (size_t k = 0; k < stride; ++k) {
+                uint64_t word = cells[y * stride + k];
+                for (uint64_t changed = word ^ m_board[y * stride + k]; changed != 0; changed &= changed - 1) {
+                    unsigned bit = __builtin_ctzll(changed);
+                    size_t x = 64 * k + bit;
+                    if (x < width())
+                        fill_block(x, y, (word >> bit) & 1U);
+                }
+            }
+        }
+    }
+    m_board = cells;
+}
+
+/**
+ * @brief Encodes the canvas to a PNG file.
+ *
+ * A PALETTE canvas is written as a 1-bit image whose palette is the dead and
+ * the live color of the board drawn last. The color mode is given to lodepng,
+ * which then neither converts the pixels nor scans them for a palette of its own.
+ *
+ * @param filename The name of the file where the PNG image will be saved.
+ */
+void Canvas::save_png(const std::string& filename) const {
+    if (m_format == RGBA) {
+        encode_png(filename.c_str(), pixels(), virtual_width(), virtual_height());
+        return;
+    }
+    lodepng::State state;
+    for (LodePNGColorMode* mode : { &state.info_raw, &state.info_png.color }) {
+        mode->colortype = LCT_PALETTE;
+        mode->bitdepth = 1;
+        for (uint32_t color : { m_board_bkg, m_board_alive }) {
+            component_t bytes[image_depth];
+            std::memcpy(bytes, &color, sizeof(color));
+            lodepng_palette_add(mode, bytes[Color::R], bytes[Color::G], bytes[Color::B], 255);
+        }
+    }
+    state.encoder.auto_convert = 0;
+
+    // Lodepng expects the rows of a raw image with less than 8 bits per pixel one right after the other.
+    const component_t* image = pixels();
+    vector<component_t> packed;
+    if (m_width % 8 != 0) {
+        packed.assign((m_width * m_height + 7) / 8, 0);
+        for (size_t row = 0; row < m_height; ++row) {
+            const component_t* from = &m_pixels[row * row_bytes()];
+            size_t bit = row * m_width;
+            unsigned shift = bit % 8;
+            component_t* to = &packed[bit / 8];
+            for (size_t i = 0; i < row_bytes(); ++i) {
+                to[i] |= from[i] >> shift;
+                if (shift != 0 and bit / 8 + i + 1 < packed.size())
+                    to[i + 1] |= static_cast<component_t>(from[i] << (8 - shift));
+            }
+        }
+        image = packed.data();
+    }
+    std::vector<unsigned char> png;
+    unsigned error = lodepng::encode(png, image, virtual_width(), virtual_height(), state);
+    if (error == 0U)
+        error = lodepng::save_file(png, filename);
+    if (error != 0U) {
+        std::cout << "encoder error " << error << ": " << lodepng_error_text(error) << std::endl;
+    }
 }
 
 }  // namespace life
@@ -34,6 +34,11 @@ class Canvas {
     using coord_t = unsigned long;  //!< The pixel coordinate type.
     //== Constants
     static constexpr uint8_t image_depth = 4;  //!< Default value is RGBA (4 channels).
+    /// How the pixels are stored.
+    enum format_e : uint8_t {
+        RGBA = 0,    //!< 4 bytes per pixel, any color.
+        PALETTE = 1  //!< 1 bit per pixel, rows padded to whole bytes: 1 for live cells, 0 for dead ones.
+    };
 
     //=== Special members
     /// Constructor
@@ -41,10 +46,11 @@ class Canvas {
      * @param w The canvas width in real pixels.
      * @param h The canvas height in real pixels.
      * @param bs The canvas block size in virtual pixels.
+     * @param format How the pixels are stored; a PALETTE canvas is only drawn with draw_board().
      */
-    Canvas(size_t w = 0, size_t h = 0, short bs = 4)
-        : m_width(w * bs), m_height(h * bs), m_block_size(bs) {
-        m_pixels.resize(m_height * m_width * image_depth);
+    Canvas(size_t w = 0, size_t h = 0, short bs = 4, format_e format = RGBA)
+        : m_width(w * bs), m_height(h * bs), m_block_size(bs), m_format(format) {
+        m_pixels.resize(m_height * row_bytes());
     }
     /// Destructor.
     virtual ~Canvas() = default;
@@ -72,6 +78,8 @@ class Canvas {
     [[nodiscard]] size_t virtual_width() const { return m_width; }
     /// Get the canvas height in virtual pixels
     [[nodiscard]] size_t virtual_height() const { return m_height; }
+    /// Get how the pixels are stored.
+    [[nodiscard]] format_e format() const { return m_format; }
     /// Get the canvas pixels, as an array of `unsigned char`.
     [[nodiscard]] const component_t* pixels() const { return m_pixels.data(); }
     /// Given a (real) coordinate, it tells if it's in bounds of m_pixels
@@ -95,12 +103,35 @@ class Canvas {
     }
 
     void matrix_to_png(std::vector<std::vector<int>>& matrix, std::string aliveColor, std::string bkgColor, std::string imagePath, std::string configPrefix, int genCount);
+    /// Draw a board packed 64 cells per word, redrawing only the cells changed since the last board drawn.
+    void draw_board(const vector<uint64_t>& cells, const Color& alive, const Color& bkg);
+    /// Encode the canvas to a PNG file.
+    void save_png(const std::string& filename) const;
 
   private:
+    /// A color as the 4 bytes of an RGBA pixel, ready to be copied into m_pixels.
+    static uint32_t rgba(const Color&);
+    /// Sets or clears a run of pixels of a PALETTE row, the first pixel being the top bit of a byte.
+    static void fill_bits(component_t* row, size_t first, size_t count, bool value);
+    /// Bytes of one virtual row of m_pixels.
+    [[nodiscard]] size_t row_bytes() const {
+        return m_format == RGBA ? m_width * image_depth : (m_width + 7) / 8;
+    }
+    /// Throws unless the canvas stores RGBA pixels.
+    void require_rgba() const;
+    /// Copies a scanline of row_bytes() bytes over every virtual row of a row of blocks.
+    void fill_block_row(coord_t y, const void* scanline);
+    /// Paints the block of a single (real) pixel, with the colors of m_board.
+    void fill_block(coord_t x, coord_t y, bool live);
+
     size_t m_width;                //!< The image width in virtual units.
     size_t m_height;               //!< The image height in virtual units.
     short m_block_size;            //!< Cell size in virtual pixels
-    vector<component_t> m_pixels;  //!< The pixels, stored as 3 RGB components.
+    format_e m_format;             //!< How m_pixels is stored.
+    vector<component_t> m_pixels;  //!< The pixels, stored as RGBA components or as bits; see format_e.
+    vector<uint64_t> m_board;      //!< Board last drawn by draw_board(); empty once pixels are drawn otherwise.
+    uint32_t m_board_alive = 0;    //!< Color of the live cells of m_board, from rgba().
+    uint32_t m_board_bkg = 0;      //!< Color of the dead cells of m_board, from rgba().
 };
 }  // namespace life
 
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "archive.h"
+#include "../lib/lodepng.h"
+
+namespace life {
+
+    namespace {
+        void put_varint(std::vector<unsigned char>& out, std::uint64_t value) {
+            while(value >= 0x80){
+                out.push_back(static_cast<unsigned char>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<unsigned char>(value));
+        }
+
+        std::uint64_t get_varint(const unsigned char*& in) {
+            std::uint64_t value = 0;
+            for(int shift = 0; ; shift += 7){
+                unsigned char byte = *in++;
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if(byte < 0x80){
+                    return value;
+                }
+            }
+        }
+
+        std::vector<unsigned char> deflate(const unsigned char* data, std::size_t size) {
+            std::vector<unsigned char> out;
+            unsigned error = lodepng::compress(out, data, size);
+            if(error){
+                std::cerr << ">>> Error compressing the archive: " << lodepng_error_text(error) << std::endl;
+                exit(1);
+            }
+            return out;
+        }
+
+        std::vector<unsigned char> inflate(const std::vector<unsigned char>& data) {
+            std::vector<unsigned char> out;
+            unsigned error = lodepng::decompress(out, data);
+            if(error){
+                std::cerr << ">>> Error decompressing the archive: " << lodepng_error_text(error) << std::endl;
+                exit(1);
+            }
+            return out;
+        }
+    }
+
+    StateArchive::StateArchive(long interval) : m_interval(std::max(1L, interval)) {}
+
+/**
+ * @brief Deflates the changes of the last segment, before a new one starts.
+ */
+    void StateArchive::seal() {
+        if(!m_segments.empty() && !m_segments.back().sealed){
+            Segment& segment = m_segments.back();
+            segment.changes = deflate(segment.changes.data(), segment.changes.size());
+            segment.sealed = true;
+        }
+    }
+
+/**
+ * @brief Records a board: as a keyframe when the segment is full, else as the cells that changed.
+ *
+ * A change record holds the number of generations since the previous record, the
+ * number of cells that changed, and the distance between the index
+ * (row * cols + col) of each cell and the previous one, all as varints. Changed
+ * cells are found a word at a time, by XOR with the previous board.
+ *
+ * @param engine Engine holding the board.
+ * @param generation Generation of the board.
+ */
+    void StateArchive::record(const Engine& engine, long generation) {
+        m_cols = engine.cols();
+        engine.pack(m_current);
+        if(m_segments.empty() || generation - m_segments.back().first >= m_interval){
+            seal();
+            Segment segment;
+            segment.first = generation;
+            segment.keyframe = deflate(reinterpret_cast<const unsigned char*>(m_current.data()),
+                                       m_current.size() * sizeof(std::uint64_t));
+            m_segments.push_back(std::move(segment));
+        }else{
+            Segment& segment = m_segments.back();
+            std::size_t stride = words_per_row(m_cols);
+            std::uint64_t count = 0;
+            for(std::size_t k = 0; k < m_current.size(); k++){
+                count += __builtin_popcountll(m_current[k] ^ m_board[k]);
+            }
+            put_varint(segment.changes, static_cast<std::uint64_t>(generation - segment.last));
+            put_varint(segment.changes, count);
+            std::uint64_t previous = 0;
+            for(std::size_t k = 0; k < m_current.size(); k++){
+                for(std::uint64_t changed = m_current[k] ^ m_board[k]; changed != 0; changed &= changed - 1){
+                    std::uint64_t col = (k % stride) * 64 + __builtin_ctzll(changed);
+                    std::uint64_t index = (k / stride) * m_cols + col;
+                    put_varint(segment.changes, index - previous);
+                    previous = index;
+                }
+            }
+        }
+        m_segments.back().last = generation;
+        std::swap(m_board, m_current);
+    }
+
+/**
+ * @brief Rebuilds the latest board of a segment up to a generation.
+ *
+ * @param segment Segment whose keyframe is not after the generation.
+ * @param generation Generation wanted.
+ * @param board Where the board is rebuilt, packed like Engine::pack().
+ * @param used If not null, receives how many bytes of the inflated changes were applied.
+ * @return The generation of the board rebuilt.
+ */
+    long StateArchive::decode(const Segment& segment, long generation, std::vector<std::uint64_t>& board,
+                              std::size_t* used) const {
+        std::vector<unsigned char> keyframe = inflate(segment.keyframe);
+        board.resize(keyframe.size() / sizeof(std::uint64_t));
+        std::memcpy(board.data(), keyframe.data(), keyframe.size());
+
+        std::vector<unsigned char> inflated;
+        const std::vector<unsigned char>* changes = &segment.changes;
+        if(segment.sealed){
+            inflated = inflate(segment.changes);
+            changes = &inflated;
+        }
+        std::size_t stride = words_per_row(m_cols);
+        const unsigned char* in = changes->data();
+        const unsigned char* end = in + changes->size();
+        long reached = segment.first;
+        while(in != end){
+            const unsigned char* next = in;
+            long gap = static_cast<long>(get_varint(next));
+            if(reached + gap > generation){
+                break;
+            }
+            reached += gap;
+            std::uint64_t count = get_varint(next);
+            std::uint64_t index = 0;
+            for(std::uint64_t cell = 0; cell < count; cell++){
+                index += get_varint(next);
+                std::uint64_t row = index / m_cols;
+                std::uint64_t col = index % m_cols;
+                board[row * stride + col / 64] ^= std::uint64_t{1} << (col % 64);
+            }
+            in = next;
+        }
+        if(used){
+            *used = static_cast<std::size_t>(in - changes->data());
+        }
+        return reached;
+    }
+
+/**
+ * @brief Restores a generation: inflates the keyframe before it and applies the changes since.
+ *
+ * @param generation Generation wanted.
+ * @param engine Engine of the same size as the boards recorded; its board is replaced.
+ * @return The generation of the board restored, or -1 if none was recorded that early.
+ */
+    long StateArchive::restore(long generation, Engine& engine) const {
+        auto after = std::upper_bound(m_segments.begin(), m_segments.end(), generation,
+                                      [](long wanted, const Segment& segment){return wanted < segment.first;});
+        if(after == m_segments.begin()){
+            return -1;
+        }
+        std::vector<std::uint64_t> board;
+        long reached = decode(*(after - 1), generation, board);
+        engine.unpack(board);
+        return reached;
+    }
+
+/**
+ * @brief Drops the boards recorded after a generation, and reopens the segment holding it.
+ */
+    void StateArchive::truncate(long generation) {
+        while(!m_segments.empty() && m_segments.back().first > generation){
+            m_segments.pop_back();
+        }
+        if(m_segments.empty()){
+            m_board.clear();
+            return;
+        }
+        Segment& segment = m_segments.back();
+        std::size_t used = 0;
+        segment.last = decode(segment, generation, m_board, &used);
+        if(segment.sealed){
+            segment.changes = inflate(segment.changes);
+            segment.sealed = false;
+        }
+        segment.changes.resize(used);
+    }
+
+    std::size_t StateArchive::bytes() const {
+        std::size_t total = 0;
+        for(const Segment& segment : m_segments){
+            total += segment.keyframe.size() + segment.changes.size();
+        }
+        return total;
+    }
+
+}
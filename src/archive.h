@@ -0,0 +1,73 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "engine.h"
+
+namespace life {
+    //! Compressed boards of every generation of a run, to go back to any of them.
+    /*!
+     * Generations are grouped in segments of `interval` generations. A segment
+     * starts with a keyframe, the whole board deflated, followed by the cells
+     * born or dead in each later generation of the segment. The changes of the
+     * segment being recorded are kept as they are, and deflated once the next
+     * keyframe starts.
+     *
+     * Restoring a generation inflates one keyframe and applies at most
+     * `interval` generations of changes to it.
+     */
+    class StateArchive {
+        private:
+            struct Segment {
+                long first = 0;                     //!< Generation of the keyframe.
+                long last = 0;                      //!< Last generation recorded in the segment.
+                std::vector<unsigned char> keyframe;
+                std::vector<unsigned char> changes; //!< Deflated once the segment is sealed.
+                bool sealed = false;                //!< Whether a later segment started.
+            };
+
+            long m_interval;
+            int m_cols = 0;
+            std::vector<Segment> m_segments;
+            std::vector<std::uint64_t> m_board;     //!< Last board recorded, packed like Engine::pack().
+            std::vector<std::uint64_t> m_current;   //!< Scratch board for record().
+
+            void seal();
+            long decode(const Segment& segment, long generation, std::vector<std::uint64_t>& board,
+                        std::size_t* used = nullptr) const;
+
+        public:
+            /**
+             * @param interval Generations between two keyframes.
+             */
+            explicit StateArchive(long interval);
+
+            /**
+             * @brief Records the board of a generation.
+             *
+             * Generations must be recorded in increasing order, but not necessarily one
+             * apart, and from engines of the same size.
+             */
+            void record(const Engine& engine, long generation);
+            /**
+             * @brief Puts the latest recorded board up to a generation on an engine.
+             *
+             * @return The generation of the board restored, or -1 if none was recorded that early.
+             */
+            long restore(long generation, Engine& engine) const;
+            /// Forgets the generations recorded after the given one, so recording can go on from it.
+            void truncate(long generation);
+
+            /// First generation recorded, or -1.
+            long first_generation() const {return m_segments.empty() ? -1 : m_segments.front().first;}
+            /// Last generation recorded, or -1.
+            long last_generation() const {return m_segments.empty() ? -1 : m_segments.back().last;}
+            /// Bytes of compressed keyframes and changes.
+            std::size_t bytes() const;
+    };
+}
+
+#endif // ARCHIVE_H
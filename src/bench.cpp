@@ -0,0 +1,378 @@
+/**
+ * @file bench.cpp
+ *
+ * @description
+ * Measures the stepping throughput, in cells per second, of every engine and
+ * row kernel available on this CPU, and checks that they all agree with the
+ * portable bit-packed kernel, on the board measured and on one of odd size,
+ * the tiles engine included, and that hashlife jumps of 2^k generations end
+ * where as many steps do.
+ * It checks canonical_hash() on the rotations and reflections of a pattern,
+ * and that a StateArchive gives back the boards of a run.
+ * It also counts the heap allocations made by each engine once warmed up, and
+ * fails if a dense engine allocates while stepping.
+ *
+ * Usage: glife_bench [rows cols]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "archive.h"
+#include "engine.h"
+#include "bit_kernel.h"
+
+using life::Engine;
+
+/// Heap allocations made so far by the whole program.
+static std::atomic<long> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount++;
+    if(void* memory = std::malloc(size == 0 ? 1 : size)){
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+/// Fills the board with a random soup of roughly 1/3 density, always the same one.
+void fill_random(Engine& engine) {
+    std::mt19937 generator(2024);
+    std::uniform_int_distribution<int> coin(0, 2);
+    for(int ii = 0; ii < engine.rows(); ii++){
+        for(int jj = 0; jj < engine.cols(); jj++){
+            engine.set(ii, jj, coin(generator) == 0);
+        }
+    }
+}
+
+/// Tells whether two engines hold the same board.
+bool same_board(const Engine& a, const Engine& b) {
+    for(int ii = 0; ii < a.rows(); ii++){
+        for(int jj = 0; jj < a.cols(); jj++){
+            if(a.alive(ii, jj) != b.alive(ii, jj)){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Steps the engine for about one second and returns the measured cells per second.
+double measure(Engine& engine) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    long generations = 0;
+    double elapsed = 0;
+    while(elapsed < 1.0){
+        engine.step();
+        generations++;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    }
+    return static_cast<double>(engine.rows()) * engine.cols() * generations / elapsed;
+}
+
+/// Makes the engine that runs a kernel, or returns null if this CPU lacks it.
+std::unique_ptr<Engine> make_kernel_engine(const std::string& kernel, int rows, int cols, const life::Rule& rule) {
+    life::EngineOptions options;
+    if(kernel == "cell"){
+        return life::make_engine("scalar", rows, cols, rule);
+    }else if(kernel == "lut" || kernel == "changelist" || kernel == "hashlife"){
+        return life::make_engine(kernel, rows, cols, rule);
+    }else if(kernel == "threads"){
+        // Best kernel on every core.
+        options.threads = 0;
+        return life::make_engine("bitgrid", rows, cols, rule, options);
+    }else if(life::kernel_supported(kernel)){
+        options.kernel = kernel;
+        return life::make_engine("bitgrid", rows, cols, rule, options);
+    }
+    return nullptr;
+}
+
+/// Kernels compared and timed, see make_kernel_engine().
+const char* const kernels[] = {"cell", "lut", "changelist", "hashlife", "scalar", "sse2", "avx2", "threads"};
+
+/**
+ * Steps every kernel from the same soup and tells whether they all end on the
+ * board of the portable bit-packed kernel, printing the ones that do not.
+ *
+ * The tiles engine lets cells live past the board, so it is compared with the
+ * middle of a larger board, whose sides the soup cannot reach in the
+ * generations checked.
+ */
+bool kernels_agree(int rows, int cols, const life::Rule& rule) {
+    const int checkGenerations = 16;
+    life::EngineOptions reference;
+    reference.kernel = "scalar";
+    auto expected = life::make_engine("bitgrid", rows, cols, rule, reference);
+    fill_random(*expected);
+    for(int gen = 0; gen < checkGenerations; gen++){
+        expected->step();
+    }
+
+    bool allMatch = true;
+    for(std::string kernel : kernels){
+        auto engine = make_kernel_engine(kernel, rows, cols, rule);
+        if(!engine){
+            continue;
+        }
+        fill_random(*engine);
+        for(int gen = 0; gen < checkGenerations; gen++){
+            engine->step();
+        }
+        if(!same_board(*engine, *expected)){
+            std::cout << "    " << kernel << " on " << rows << "x" << cols << ": [MISMATCH]" << std::endl;
+            allMatch = false;
+        }
+    }
+
+    const int margin = checkGenerations + 2;
+    auto tiles = life::make_engine("tiles", rows, cols, rule);
+    fill_random(*tiles);
+    auto unbounded = life::make_engine("bitgrid", rows + 2 * margin, cols + 2 * margin, rule, reference);
+    for(int ii = 0; ii < rows; ii++){
+        for(int jj = 0; jj < cols; jj++){
+            unbounded->set(ii + margin, jj + margin, tiles->alive(ii, jj));
+        }
+    }
+    for(int gen = 0; gen < checkGenerations; gen++){
+        tiles->step();
+        unbounded->step();
+    }
+    for(int ii = -margin; ii < rows + margin; ii++){
+        for(int jj = -margin; jj < cols + margin; jj++){
+            if(tiles->alive(ii, jj) != unbounded->alive(ii + margin, jj + margin)){
+                std::cout << "    tiles on " << rows << "x" << cols << ": [MISMATCH]" << std::endl;
+                return false;
+            }
+        }
+    }
+    return allMatch;
+}
+
+/**
+ * Advances the hashlife engine 2^k generations in one call, for k up to 6, and
+ * tells whether each jump ends on the board of as many single steps of the
+ * bit-packed engine. The soup sits in the middle of a board large enough for
+ * the whole jump to be safe, which is checked too.
+ */
+bool hashlife_jumps_agree(const life::Rule& rule) {
+    const int size = 256;
+    const int soup = 32;
+    auto cells = life::make_engine("bitgrid", soup, soup, rule);
+    fill_random(*cells);
+
+    bool ok = true;
+    for(int k = 0; k <= 6; k++){
+        auto hashlife = life::make_engine("hashlife", size, size, rule);
+        auto expected = life::make_engine("bitgrid", size, size, rule);
+        for(int ii = 0; ii < soup; ii++){
+            for(int jj = 0; jj < soup; jj++){
+                hashlife->set(ii + (size - soup) / 2, jj + (size - soup) / 2, cells->alive(ii, jj));
+                expected->set(ii + (size - soup) / 2, jj + (size - soup) / 2, cells->alive(ii, jj));
+            }
+        }
+        long jump = hashlife->advance(1L << k);
+        for(long gen = 0; gen < (1L << k); gen++){
+            expected->step();
+        }
+        if(jump != (1L << k) || !same_board(*hashlife, *expected)){
+            std::cout << "    hashlife jump of " << (1L << k) << " generations: [MISMATCH]" << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/// Makes an engine with the given live cells, each moved by (`top`, `left`).
+std::unique_ptr<Engine> make_pattern(int rows, int cols, const std::vector<std::pair<int, int>>& cells,
+                                     int top, int left) {
+    auto engine = life::make_engine("bitgrid", rows, cols, life::Rule());
+    for(const auto& [row, col] : cells){
+        engine->set(row + top, col + left, true);
+    }
+    return engine;
+}
+
+/**
+ * Checks that canonical_hash() gives the same fingerprint to the 8 rotations and
+ * reflections of asymmetric patterns, wherever they are, and that patterns of
+ * different shapes whose words are alike get different fingerprints.
+ */
+bool canonical_hashes_agree() {
+    // The R-pentomino, and a pattern wider than a word.
+    const std::vector<std::vector<std::pair<int, int>>> patterns = {
+        {{0, 1}, {0, 2}, {1, 0}, {1, 1}, {2, 1}},
+        {{0, 0}, {0, 1}, {1, 70}, {2, 5}, {3, 100}, {3, 101}}
+    };
+    bool ok = true;
+    for(const auto& pattern : patterns){
+        int size = 0;
+        for(const auto& [row, col] : pattern){
+            size = std::max({size, row + 1, col + 1});
+        }
+        life::Hash128 expected = make_pattern(size, size, pattern, 0, 0)->canonical_hash();
+        for(int orientation = 0; orientation < 8; orientation++){
+            std::vector<std::pair<int, int>> oriented;
+            for(auto [row, col] : pattern){
+                if(orientation & 1){
+                    col = size - 1 - col;
+                }
+                if(orientation & 2){
+                    row = size - 1 - row;
+                }
+                if(orientation & 4){
+                    std::swap(row, col);
+                }
+                oriented.emplace_back(row, col);
+            }
+            if(make_pattern(size + 70, size + 130, oriented, 7, 61)->canonical_hash() != expected){
+                std::cout << "    canonical hash of orientation " << orientation << ": [MISMATCH]" << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    // A single row and a box of three rows whose words are the same.
+    auto row = make_pattern(1, 130, {{0, 0}, {0, 63}, {0, 64}, {0, 127}, {0, 129}}, 0, 0);
+    auto box = make_pattern(3, 64, {{0, 0}, {0, 63}, {1, 0}, {1, 63}, {2, 1}}, 0, 0);
+    if(row->canonical_hash() == box->canonical_hash() || row->shape_hash().hash == box->shape_hash().hash){
+        std::cout << "    hashes of different shapes: [COLLISION]" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+/**
+ * Records a run in a StateArchive, then restores generations on keyframes,
+ * between them and at the ends, and checks each against the same generation
+ * simulated again from the start. Recording then goes on after a truncate().
+ */
+bool archive_round_trip(const life::Rule& rule) {
+    const int rows = 101;
+    const int cols = 131;
+    const long interval = 16;
+    const long generations = 200;
+    life::StateArchive archive(interval);
+    auto engine = life::make_engine("bitgrid", rows, cols, rule);
+    fill_random(*engine);
+    for(long gen = 1; gen <= generations; gen++){
+        archive.record(*engine, gen);
+        engine->step();
+    }
+
+    // The hash of generation `gen`, simulated again from the soup.
+    auto replayed_hash = [&](long gen){
+        auto fresh = life::make_engine("bitgrid", rows, cols, rule);
+        fill_random(*fresh);
+        for(long done = 1; done < gen; done++){
+            fresh->step();
+        }
+        return fresh->state_hash();
+    };
+
+    bool ok = true;
+    auto restored = life::make_engine("lut", rows, cols, rule);
+    for(long gen : {1L, 2L, 16L, 17L, 18L, 40L, 113L, 128L, 129L, 199L, 200L}){
+        if(archive.restore(gen, *restored) != gen || restored->state_hash() != replayed_hash(gen)){
+            std::cout << "    archive, generation " << gen << ": [MISMATCH]" << std::endl;
+            ok = false;
+        }
+    }
+
+    // Going back to generation 50 and on from it must record the same run again.
+    archive.restore(50, *engine);
+    archive.truncate(50);
+    for(long gen = 51; gen <= 90; gen++){
+        engine->step();
+        archive.record(*engine, gen);
+    }
+    for(long gen : {50L, 51L, 64L, 65L, 90L}){
+        if(archive.restore(gen, *restored) != gen || restored->state_hash() != replayed_hash(gen)){
+            std::cout << "    archive after truncate, generation " << gen << ": [MISMATCH]" << std::endl;
+            ok = false;
+        }
+    }
+    if(archive.last_generation() != 90 || archive.restore(0, *restored) != -1){
+        std::cout << "    archive bounds: [MISMATCH]" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int rows = 1024;
+    int cols = 1024;
+    if(argc == 3){
+        rows = std::atoi(argv[1]);
+        cols = std::atoi(argv[2]);
+    }
+    life::Rule rule;
+
+    std::cout << ">>> Board of " << rows << " rows by " << cols << " cols, rule B3/S23." << std::endl;
+
+    // Odd sizes leave a partial 2x2 block and a partial last word.
+    bool allMatch = kernels_agree(rows, cols, rule) && kernels_agree(101, 131, rule);
+    allMatch = hashlife_jumps_agree(rule) && allMatch;
+    allMatch = canonical_hashes_agree() && allMatch;
+    allMatch = archive_round_trip(rule) && allMatch;
+
+    for(std::string kernel : kernels){
+        auto engine = make_kernel_engine(kernel, rows, cols, rule);
+        if(!engine){
+            std::cout << "    " << kernel << ": not supported by this CPU" << std::endl;
+            continue;
+        }
+        fill_random(*engine);
+        double cellsPerSecond = measure(*engine);
+        std::cout << "    " << kernel << ": " << cellsPerSecond << " cells/s" << std::endl;
+    }
+
+    // Steady state: after warming up, stepping a dense engine must not allocate.
+    const int warmupGenerations = 64;
+    const int countedGenerations = 64;
+    bool noAllocations = true;
+    std::cout << ">>> Heap allocations per generation, after " << warmupGenerations << " generations:" << std::endl;
+    for(std::string name : {"scalar", "bitgrid", "bitgrid-threads", "changelist", "lut", "hashlife", "tiles"}){
+        life::EngineOptions options;
+        bool dense = name != "hashlife" && name != "tiles";
+        if(name == "bitgrid-threads"){
+            options.threads = 4;
+            name = "bitgrid";
+        }
+        auto engine = life::make_engine(name, rows, cols, rule, options);
+        fill_random(*engine);
+        for(int gen = 0; gen < warmupGenerations; gen++){
+            engine->step();
+        }
+        long before = allocationCount;
+        for(int gen = 0; gen < countedGenerations; gen++){
+            engine->step();
+        }
+        double perGeneration = static_cast<double>(allocationCount - before) / countedGenerations;
+        bool failed = dense && perGeneration > 0;
+        noAllocations = noAllocations && !failed;
+        std::cout << "    " << name << (options.threads > 1 ? " (4 threads)" : "") << ": " << perGeneration
+                  << (failed ? "  [ALLOCATES]" : "") << std::endl;
+    }
+
+    return (allMatch && noAllocations) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
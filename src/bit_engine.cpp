@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <utility>
+
+#include "bit_engine.h"
+
+namespace life {
+
+/**
+ * @brief Creates an empty bit-packed board.
+ *
+ * @param rows Number of rows of the board.
+ * @param cols Number of columns of the board.
+ * @param rule Birth and survival conditions.
+ * @param kernel Row kernel used to compute the next generation.
+ * @param threads Threads stepping the board; zero uses every core.
+ * @param topology How the edges of the board connect.
+ */
+    BitEngine::BitEngine(int rows, int cols, const Rule& rule, RowKernel kernel, int threads, Topology topology)
+        : m_rows(rows), m_cols(cols), m_rule(rule), m_kernel(kernel), m_topology(topology) {
+        m_words = (static_cast<std::size_t>(cols) + 63) / 64;
+        m_stride = m_words + 2;
+        m_lastMask = (cols % 64 == 0) ? ~std::uint64_t{0} : ((std::uint64_t{1} << (cols % 64)) - 1);
+        m_cells.assign((static_cast<std::size_t>(rows) + 2) * m_stride, 0);
+        m_next.assign(m_cells.size(), 0);
+        if(threads != 1){
+            m_pool = std::make_unique<ThreadPool>(threads);
+            m_bandDeltas.resize(m_pool->size());
+        }
+    }
+
+    bool BitEngine::alive(int row, int col) const {
+        return (row_ptr(m_cells, row)[col / 64] >> (col % 64)) & 1u;
+    }
+
+    void BitEngine::set(int row, int col, bool alive) {
+        std::uint64_t bit = std::uint64_t{1} << (col % 64);
+        std::uint64_t& word = row_ptr(m_cells, row)[col / 64];
+        std::uint64_t before = word;
+        word = alive ? (word | bit) : (word & ~bit);
+        m_hash ^= zobrist_row_delta(&before, &word, 1, (col / 64 + 1 == static_cast<int>(m_words)) ? m_lastMask : ~std::uint64_t{0},
+                                    row * m_words + col / 64);
+    }
+
+/**
+ * @brief Computes the next generation of a range of rows into the back buffer.
+ *
+ * @param firstRow First row to compute.
+ * @param lastRow One past the last row to compute.
+ * @return The change of the fingerprint over these rows.
+ */
+    Hash128 BitEngine::step_rows(int firstRow, int lastRow) {
+        Hash128 delta;
+        for(int row = firstRow; row < lastRow; row++){
+            std::uint64_t* out = row_ptr(m_next, row);
+            m_kernel(row_ptr(m_cells, row - 1), row_ptr(m_cells, row), row_ptr(m_cells, row + 1), out, m_words, m_rule);
+            // Cells past the last column are outside the board and stay dead.
+            out[m_words - 1] &= m_lastMask;
+            delta ^= zobrist_row_delta(row_ptr(m_cells, row), out, m_words, m_lastMask, row * m_words);
+        }
+        return delta;
+    }
+
+/**
+ * @brief Copies the cells across the joined edges into the padding around the board.
+ *
+ * The columns are copied first, so that the rows copied next carry their corners.
+ * Every halo cell is rewritten, since the padding of the back buffer holds the
+ * halo of two generations ago.
+ */
+    void BitEngine::fill_halo() {
+        if(m_topology == Topology::plane){
+            return;
+        }
+
+        for(int row = 0; row < m_rows; row++){
+            std::uint64_t* cells = row_ptr(m_cells, row);
+            set_halo_bit(cells, -1, halo_bit(cells, m_cols - 1));
+            set_halo_bit(cells, m_cols, halo_bit(cells, 0));
+        }
+
+        std::uint64_t* top = row_ptr(m_cells, -1) - 1;
+        std::uint64_t* bottom = row_ptr(m_cells, m_rows) - 1;
+        const std::uint64_t* first = row_ptr(m_cells, 0) - 1;
+        const std::uint64_t* last = row_ptr(m_cells, m_rows - 1) - 1;
+        if(m_topology == Topology::torus){
+            std::copy(last, last + m_stride, top);
+            std::copy(first, first + m_stride, bottom);
+        }else if(m_topology == Topology::klein){
+            // Crossing the top or bottom edge also mirrors the column.
+            for(long col = -1; col <= m_cols; col++){
+                set_halo_bit(top + 1, col, halo_bit(last + 1, m_cols - 1 - col));
+                set_halo_bit(bottom + 1, col, halo_bit(first + 1, m_cols - 1 - col));
+            }
+        }
+    }
+
+/**
+ * @brief Advances the board one generation and swaps the buffers.
+ */
+    void BitEngine::step() {
+        fill_halo();
+        if(m_pool && m_pool->size() > 1){
+            long bands = m_pool->size();
+            m_pool->parallel_for(static_cast<int>(bands), [this, bands](int band){
+                m_bandDeltas[band] = step_rows(static_cast<int>(m_rows * band / bands), static_cast<int>(m_rows * (band + 1) / bands));
+            });
+            for(const Hash128& delta : m_bandDeltas){
+                m_hash ^= delta;
+            }
+        }else{
+            m_hash ^= step_rows(0, m_rows);
+        }
+        std::swap(m_cells, m_next);
+    }
+
+    long BitEngine::population() const {
+        long count = 0;
+        for(int row = 0; row < m_rows; row++){
+            const std::uint64_t* cells = row_ptr(m_cells, row);
+            for(std::size_t k = 0; k + 1 < m_words; k++){
+                count += __builtin_popcountll(cells[k]);
+            }
+            count += __builtin_popcountll(cells[m_words - 1] & m_lastMask);
+        }
+        return count;
+    }
+
+    std::unique_ptr<Engine> BitEngine::clone() const {
+        auto copy = std::make_unique<BitEngine>(m_rows, m_cols, m_rule, m_kernel, 1, m_topology);
+        copy->m_cells = m_cells;
+        copy->m_hash = m_hash;
+        return copy;
+    }
+
+    void BitEngine::pack(std::vector<std::uint64_t>& words) const {
+        words.resize(m_rows * m_words);
+        for(int row = 0; row < m_rows; row++){
+            const std::uint64_t* cells = row_ptr(m_cells, row);
+            std::copy(cells, cells + m_words, words.begin() + row * m_words);
+            words[(row + 1) * m_words - 1] &= m_lastMask;
+        }
+    }
+
+    void BitEngine::unpack(const std::vector<std::uint64_t>& words) {
+        for(int row = 0; row < m_rows; row++){
+            std::uint64_t* cells = row_ptr(m_cells, row);
+            const std::uint64_t* source = words.data() + row * m_words;
+            m_hash ^= zobrist_row_delta(cells, source, m_words, m_lastMask, row * m_words);
+            std::copy(source, source + m_words, cells);
+            cells[m_words - 1] &= m_lastMask;
+        }
+    }
+
+}
@@ -0,0 +1,88 @@
+#ifndef BIT_ENGINE_H
+#define BIT_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "engine.h"
+#include "bit_kernel.h"
+#include "thread_pool.h"
+
+namespace life {
+    /// How the edges of the board connect.
+    enum class Topology {
+        plane,      //!< Dead cells all around the board.
+        torus,      //!< Left edge joined to the right one, top edge joined to the bottom one.
+        klein,      //!< Like the torus, but the top and bottom edges are joined with a left-right flip.
+        cylinder    //!< Left edge joined to the right one; dead cells above and below.
+    };
+
+    //! Engine that stores 64 cells per word and steps them with bitwise adders.
+    /*!
+     * Every row is stored as `m_words` words plus a dead padding word on each side,
+     * and the board has a dead padding row above and below, so the kernel never
+     * needs to check bounds. Two buffers are kept and swapped after every step.
+     *
+     * With more than one thread, each step splits the board in horizontal bands
+     * that are computed in parallel. A band only reads the current buffer and only
+     * writes its own rows of the back buffer, so the result does not depend on the
+     * number of threads.
+     *
+     * Wrap-around topologies reuse the padding as a halo: before each step, the
+     * cells across each joined edge are copied into the padding next to it, so the
+     * kernel runs unchanged, with no per-cell wrapping.
+     *
+     * The Zobrist fingerprint of the board is updated from the words that changed
+     * in each step, while they are still in cache.
+     */
+    class BitEngine : public Engine {
+        private:
+            int m_rows;
+            int m_cols;
+            Rule m_rule;
+            RowKernel m_kernel;
+            Topology m_topology;
+            std::size_t m_words;            //!< Words holding the cells of a row.
+            std::size_t m_stride;           //!< Words between the start of two rows (with padding).
+            std::uint64_t m_lastMask;       //!< Valid bits of the last word of a row.
+            std::vector<std::uint64_t> m_cells;
+            std::vector<std::uint64_t> m_next;
+            std::unique_ptr<ThreadPool> m_pool;    //!< Null when stepping on the calling thread only.
+            std::vector<Hash128> m_bandDeltas;      //!< Fingerprint change found by each band of a step.
+            Hash128 m_hash;                         //!< Zobrist fingerprint of the board.
+
+            std::uint64_t* row_ptr(std::vector<std::uint64_t>& buffer, int row) {return buffer.data() + (row + 1) * m_stride + 1;}
+            const std::uint64_t* row_ptr(const std::vector<std::uint64_t>& buffer, int row) const {return buffer.data() + (row + 1) * m_stride + 1;}
+            /// Reads a cell of a row, from column -1 to m_cols (the halo columns).
+            static bool halo_bit(const std::uint64_t* row, long col) {return (row[(col + 64) / 64 - 1] >> ((col + 64) % 64)) & 1u;}
+            /// Writes a cell of a row, from column -1 to m_cols (the halo columns).
+            static void set_halo_bit(std::uint64_t* row, long col, bool alive) {
+                std::uint64_t& word = row[(col + 64) / 64 - 1];
+                std::uint64_t bit = std::uint64_t{1} << ((col + 64) % 64);
+                word = alive ? (word | bit) : (word & ~bit);
+            }
+            void fill_halo();
+
+        public:
+            BitEngine(int rows, int cols, const Rule& rule, RowKernel kernel = step_row_scalar<Rule>, int threads = 1,
+                      Topology topology = Topology::plane);
+
+            int rows() const override {return m_rows;}
+            int cols() const override {return m_cols;}
+            bool alive(int row, int col) const override;
+            void set(int row, int col, bool alive) override;
+            void step() override;
+            long population() const override;
+            Hash128 state_hash() const override {return m_hash;}
+            ShapeHash shape_hash() const override {return packed_shape_hash(row_ptr(m_cells, 0), m_stride, m_rows, m_cols);}
+            void pack(std::vector<std::uint64_t>& words) const override;
+            void unpack(const std::vector<std::uint64_t>& words) override;
+            std::unique_ptr<Engine> clone() const override;
+
+            Hash128 step_rows(int firstRow, int lastRow);
+    };
+}
+
+#endif // BIT_ENGINE_H
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+
+#include "bit_kernel.h"
+
+namespace life {
+
+    namespace {
+        /// Vector row kernel, computing whole registers only.
+        using VectorKernel = std::size_t (*)(const std::uint64_t*, const std::uint64_t*, const std::uint64_t*,
+                                             std::uint64_t*, std::size_t, const Rule&);
+
+        /// Runs a vector kernel and finishes the row with the portable one.
+        template <VectorKernel Vector, typename R>
+        void step_row_vector(const std::uint64_t* above, const std::uint64_t* cells, const std::uint64_t* below,
+                             std::uint64_t* out, std::size_t words, const Rule& rule) {
+            std::size_t done = Vector(above, cells, below, out, words, rule);
+            step_row_scalar<R>(above + done, cells + done, below + done, out + done, words - done, rule);
+        }
+
+        /// Row kernel for an instruction set, instantiated for the rule type `R`.
+        template <typename R>
+        RowKernel kernel_for(const std::string& isa) {
+#if defined(GLIFE_X86_KERNELS)
+            if(isa == "avx2"){
+                return step_row_vector<step_row_avx2<R>, R>;
+            }
+            if(isa == "sse2"){
+                return step_row_vector<step_row_sse2<R>, R>;
+            }
+#endif
+            (void)isa;
+            return step_row_scalar<R>;
+        }
+
+        /// Tells whether a runtime rule is the given StaticRule.
+        template <typename R>
+        bool is_rule(const Rule& rule) {
+            return rule.born == R::born && rule.survive == R::survive;
+        }
+    }
+
+/**
+ * @brief Tells whether a kernel can run on this build and CPU.
+ *
+ * @param name Kernel name: "scalar", "sse2" or "avx2".
+ * @return True if the kernel is available.
+ */
+    bool kernel_supported(const std::string& name) {
+        if(name == "scalar"){
+            return true;
+        }
+#if defined(GLIFE_X86_KERNELS)
+        __builtin_cpu_init();
+        if(name == "sse2"){
+            return __builtin_cpu_supports("sse2");
+        }
+        if(name == "avx2"){
+            return __builtin_cpu_supports("avx2");
+        }
+#endif
+        return false;
+    }
+
+/**
+ * @brief Maps a configured kernel name to the kernel that will actually run.
+ *
+ * "auto" picks the widest kernel the CPU supports. A kernel the CPU lacks falls
+ * back to "auto", with a warning.
+ *
+ * @param name Kernel name: "auto", "scalar", "sse2" or "avx2".
+ * @return The name of the kernel to use.
+ */
+    std::string resolve_kernel_name(const std::string& name) {
+        if(name == "auto"){
+            if(kernel_supported("avx2")){
+                return "avx2";
+            }
+            if(kernel_supported("sse2")){
+                return "sse2";
+            }
+            return "scalar";
+        }
+        if(name != "scalar" && name != "sse2" && name != "avx2"){
+            std::cerr << ">>> Unknown kernel \"" << name << "\"!" << std::endl;
+            exit(1);
+        }
+        if(!kernel_supported(name)){
+            std::cerr << ">>> Kernel " << name << " is not supported by this CPU, choosing automatically." << std::endl;
+            return resolve_kernel_name("auto");
+        }
+        return name;
+    }
+
+/**
+ * @brief Packs a row of text into cell words, a character per cell.
+ *
+ * With SSE2, 16 characters are compared with `live` per instruction and their
+ * results gathered into a mask, so a word takes 4 comparisons; the characters
+ * after the last whole word are compared one at a time.
+ *
+ * @param text Characters of the row.
+ * @param length Number of characters.
+ * @param live Character of a live cell.
+ * @param out Words receiving the cells; the ceil(length / 64) words are overwritten,
+ *            bits past `length` being cleared.
+ */
+    void pack_chars(const char* text, std::size_t length, char live, std::uint64_t* out) {
+        std::size_t done = 0;
+#if defined(GLIFE_X86_KERNELS)
+        static const bool sse2 = kernel_supported("sse2");
+        if(sse2){
+            done = pack_chars_sse2(text, length / 64, live, out);
+        }
+#endif
+        for(std::size_t k = done; k * 64 < length; k++){
+            std::uint64_t word = 0;
+            std::size_t count = std::min<std::size_t>(64, length - k * 64);
+            for(std::size_t j = 0; j < count; j++){
+                word |= static_cast<std::uint64_t>(text[k * 64 + j] == live) << j;
+            }
+            out[k] = word;
+        }
+    }
+
+/**
+ * @brief Picks the row kernel to be used by the bit-packed engine.
+ *
+ * Conway's Life, HighLife, Day & Night and Seeds have kernels specialized at
+ * compile time, where the rule conditions are folded into the adder output.
+ * Any other rule uses the generic kernel, which reads the rule masks at run time.
+ *
+ * The generic kernel is not a lookup table: a table indexed by neighborhood
+ * gives one cell per lookup, where the adder tree gives 64 per word. It runs
+ * the same per-count terms as the specialized kernels, so the boards are the
+ * same, and skips the counts in neither mask on branches that only depend on
+ * the rule. A table of per-count masks applied to the bit planes, tried
+ * instead, was slower on every rule measured. The "lut" engine is the lookup
+ * table version for any rule.
+ *
+ * @param name Kernel name, as accepted by resolve_kernel_name().
+ * @param rule Birth and survival conditions.
+ * @return The row kernel.
+ */
+    RowKernel select_row_kernel(const std::string& name, const Rule& rule) {
+        std::string isa = resolve_kernel_name(name);
+        if(is_rule<ConwayRule>(rule)){
+            return kernel_for<ConwayRule>(isa);
+        }
+        if(is_rule<HighLifeRule>(rule)){
+            return kernel_for<HighLifeRule>(isa);
+        }
+        if(is_rule<DayAndNightRule>(rule)){
+            return kernel_for<DayAndNightRule>(isa);
+        }
+        if(is_rule<SeedsRule>(rule)){
+            return kernel_for<SeedsRule>(isa);
+        }
+        return kernel_for<Rule>(isa);
+    }
+
+}
@@ -0,0 +1,151 @@
+#ifndef BIT_KERNEL_H
+#define BIT_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "engine.h"
+
+namespace life {
+    //! Rule known at compile time, so the kernels can fold the conditions away.
+    /*!
+     * It has the same `born` and `survive` members as Rule, which the kernels also
+     * accept for any other rule.
+     */
+    template <std::uint16_t Born, std::uint16_t Survive>
+    struct StaticRule {
+        static constexpr std::uint16_t born = Born;
+        static constexpr std::uint16_t survive = Survive;
+    };
+
+    using ConwayRule = StaticRule<(1u << 3), (1u << 2) | (1u << 3)>;                                       //!< B3/S23
+    using HighLifeRule = StaticRule<(1u << 3) | (1u << 6), (1u << 2) | (1u << 3)>;                        //!< B36/S23
+    using DayAndNightRule = StaticRule<(1u << 3) | (1u << 6) | (1u << 7) | (1u << 8),
+                                       (1u << 3) | (1u << 4) | (1u << 6) | (1u << 7) | (1u << 8)>;        //!< B3678/S34678
+    using SeedsRule = StaticRule<(1u << 2), 0>;                                                            //!< B2/S
+
+    /// Adds three bit planes, producing the sum and carry planes.
+    inline void full_add(std::uint64_t a, std::uint64_t b, std::uint64_t c, std::uint64_t& sum, std::uint64_t& carry) {
+        std::uint64_t partial = a ^ b;
+        sum = partial ^ c;
+        carry = (a & b) | (partial & c);
+    }
+
+    /// Adds two bit planes, producing the sum and carry planes.
+    inline void half_add(std::uint64_t a, std::uint64_t b, std::uint64_t& sum, std::uint64_t& carry) {
+        sum = a ^ b;
+        carry = a & b;
+    }
+
+    /// Cells with exactly `N` live neighbors that are alive in the next generation.
+    template <int N, typename R>
+    inline std::uint64_t rule_term(const R& rule, std::uint64_t cells, std::uint64_t ones, std::uint64_t twos,
+                                   std::uint64_t fours, std::uint64_t eights) {
+        std::uint64_t wanted = (((rule.born >> N) & 1u) ? ~cells : 0) | (((rule.survive >> N) & 1u) ? cells : 0);
+        if(wanted == 0){
+            return 0;
+        }
+        std::uint64_t count = ((N & 1) ? ones : ~ones) & ((N & 2) ? twos : ~twos)
+                            & ((N & 4) ? fours : ~fours) & ((N & 8) ? eights : ~eights);
+        return count & wanted;
+    }
+
+    /// Applies the rule for every neighbor count from 0 to 8, unrolled at compile time.
+    template <typename R, int... N>
+    inline std::uint64_t apply_rule(const R& rule, std::uint64_t cells, std::uint64_t ones, std::uint64_t twos,
+                                    std::uint64_t fours, std::uint64_t eights, std::integer_sequence<int, N...>) {
+        return (rule_term<N>(rule, cells, ones, twos, fours, eights) | ...);
+    }
+
+    /**
+     * @brief Computes the next state of 64 cells packed in a word.
+     *
+     * Bit `j` of a word is the cell in column `j` of that word. Each neighborhood row
+     * is given as the word itself plus the words on its left and right, so the cells
+     * shifted in across the word boundary are known.
+     *
+     * @param aLeft,above,aRight The row above.
+     * @param bLeft,cells,bRight The row being computed.
+     * @param cLeft,below,cRight The row below.
+     * @param rule Birth and survival conditions, a Rule or a StaticRule.
+     * @return The 64 cells of the next generation.
+     */
+    template <typename R>
+    inline std::uint64_t step_word(std::uint64_t aLeft, std::uint64_t above, std::uint64_t aRight,
+                                   std::uint64_t bLeft, std::uint64_t cells, std::uint64_t bRight,
+                                   std::uint64_t cLeft, std::uint64_t below, std::uint64_t cRight,
+                                   const R& rule) {
+        // The eight neighbor planes: west neighbors shift left, east neighbors shift right.
+        std::uint64_t aw = (above << 1) | (aLeft >> 63);
+        std::uint64_t ae = (above >> 1) | (aRight << 63);
+        std::uint64_t bw = (cells << 1) | (bLeft >> 63);
+        std::uint64_t be = (cells >> 1) | (bRight << 63);
+        std::uint64_t cw = (below << 1) | (cLeft >> 63);
+        std::uint64_t ce = (below >> 1) | (cRight << 63);
+
+        // Count the neighbors with a tree of adders, giving a 4-bit count per cell.
+        std::uint64_t sumA, carryA, sumC, carryC, sumB, carryB;
+        full_add(aw, above, ae, sumA, carryA);
+        full_add(cw, below, ce, sumC, carryC);
+        half_add(bw, be, sumB, carryB);
+
+        std::uint64_t ones, carryOnes;
+        full_add(sumA, sumC, sumB, ones, carryOnes);
+
+        std::uint64_t twosPartial, carryTwos, twos, carryTwosLast;
+        full_add(carryA, carryC, carryB, twosPartial, carryTwos);
+        half_add(twosPartial, carryOnes, twos, carryTwosLast);
+
+        std::uint64_t fours, eights;
+        half_add(carryTwos, carryTwosLast, fours, eights);
+
+        return apply_rule(rule, cells, ones, twos, fours, eights, std::make_integer_sequence<int, 9>());
+    }
+
+    /// Computes one row of the next generation. The rows must have a padding word on each side.
+    using RowKernel = void (*)(const std::uint64_t* above, const std::uint64_t* cells, const std::uint64_t* below,
+                               std::uint64_t* out, std::size_t words, const Rule& rule);
+
+    /// Rule value used by a kernel instantiation: the StaticRule itself, or the runtime rule.
+    template <typename R>
+    struct KernelRule {
+        static R get(const Rule&) {return R{};}
+    };
+    template <>
+    struct KernelRule<Rule> {
+        static const Rule& get(const Rule& rule) {return rule;}
+    };
+
+    /// Portable row kernel, one word at a time.
+    template <typename R>
+    void step_row_scalar(const std::uint64_t* above, const std::uint64_t* cells, const std::uint64_t* below,
+                         std::uint64_t* out, std::size_t words, const Rule& rule) {
+        const auto& kernelRule = KernelRule<R>::get(rule);
+        for(std::size_t k = 0; k < words; k++){
+            out[k] = step_word(above[k - 1], above[k], above[k + 1],
+                               cells[k - 1], cells[k], cells[k + 1],
+                               below[k - 1], below[k], below[k + 1], kernelRule);
+        }
+    }
+
+    // Vector row kernels, explicitly instantiated for Rule and the StaticRule aliases above.
+    // They compute as many words as fit in whole registers and return that count.
+    template <typename R>
+    std::size_t step_row_sse2(const std::uint64_t* above, const std::uint64_t* cells, const std::uint64_t* below,
+                              std::uint64_t* out, std::size_t words, const Rule& rule);
+    template <typename R>
+    std::size_t step_row_avx2(const std::uint64_t* above, const std::uint64_t* cells, const std::uint64_t* below,
+                              std::uint64_t* out, std::size_t words, const Rule& rule);
+
+    // Vector character packer: packs as many whole words of 64 characters as fit and returns that count.
+    std::size_t pack_chars_sse2(const char* text, std::size_t words, char live, std::uint64_t* out);
+
+    bool kernel_supported(const std::string& name);
+    void pack_chars(const char* text, std::size_t length, char live, std::uint64_t* out);
+    std::string resolve_kernel_name(const std::string& name);
+    RowKernel select_row_kernel(const std::string& name, const Rule& rule);
+}
+
+#endif // BIT_KERNEL_H
@@ -0,0 +1,47 @@
+/*!
+ * AVX2 instantiation of the row kernel (4 words, 256 cells, per instruction).
+ * This file is compiled with `-mavx2` and only called when the CPU supports it.
+ */
+
+#include <immintrin.h>
+
+#include <type_traits>
+
+#include "bit_kernel.h"
+#include "bit_kernel_simd.h"
+
+namespace life {
+    namespace {
+        /// AVX2 operations on four 64-bit lanes.
+        struct Avx2 {
+            using reg = __m256i;
+            static constexpr std::size_t lanes = 4;
+
+            static reg load(const std::uint64_t* p) {return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));}
+            static void store(std::uint64_t* p, reg v) {_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);}
+            static reg zero() {return _mm256_setzero_si256();}
+            static reg ones() {return _mm256_set1_epi32(-1);}
+            static reg band(reg a, reg b) {return _mm256_and_si256(a, b);}
+            static reg bor(reg a, reg b) {return _mm256_or_si256(a, b);}
+            static reg bxor(reg a, reg b) {return _mm256_xor_si256(a, b);}
+            static reg bnot(reg a) {return _mm256_xor_si256(a, ones());}
+            static reg andnot(reg a, reg b) {return _mm256_andnot_si256(a, b);}
+            static reg west(reg x, reg left) {return _mm256_or_si256(_mm256_slli_epi64(x, 1), _mm256_srli_epi64(left, 63));}
+            static reg east(reg x, reg right) {return _mm256_or_si256(_mm256_srli_epi64(x, 1), _mm256_slli_epi64(right, 63));}
+        };
+    }
+
+    template <typename R>
+    std::size_t step_row_avx2(const std::uint64_t* above, const std::uint64_t* cells, const std::uint64_t* below,
+                              std::uint64_t* out, std::size_t words, const Rule& rule) {
+        // Kept local instead of using KernelRule, so no inline function shared with
+        // the portable code is compiled with this file's instruction set.
+        if constexpr (std::is_same_v<R, Rule>){
+            return step_row_simd<Avx2>(above, cells, below, out, words, rule);
+        }else{
+            return step_row_simd<Avx2>(above, cells, below, out, words, R{});
+        }
+    }
+
+    GLIFE_INSTANTIATE_ROW_KERNEL(step_row_avx2)
+}
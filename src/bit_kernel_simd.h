@@ -0,0 +1,101 @@
+#ifndef BIT_KERNEL_SIMD_H
+#define BIT_KERNEL_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "engine.h"
+
+namespace life {
+    /// Vector version of rule_term(): cells with exactly `N` live neighbors that are alive next.
+    template <typename V, int N, typename R>
+    inline typename V::reg rule_term_simd(const R& rule, typename V::reg cells, typename V::reg ones, typename V::reg twos,
+                                          typename V::reg fours, typename V::reg eights) {
+        // Constants for a StaticRule; for a Rule they are the same for the whole row.
+        const bool born = (rule.born >> N) & 1u;
+        const bool survive = (rule.survive >> N) & 1u;
+        if(!born && !survive){
+            return V::zero();
+        }
+        typename V::reg count = V::band(V::band((N & 1) ? ones : V::bnot(ones), (N & 2) ? twos : V::bnot(twos)),
+                                        V::band((N & 4) ? fours : V::bnot(fours), (N & 8) ? eights : V::bnot(eights)));
+        if(born && survive){
+            return count;
+        }
+        return born ? V::andnot(cells, count) : V::band(cells, count);
+    }
+
+    /// Vector version of apply_rule().
+    template <typename V, typename R, int... N>
+    inline typename V::reg apply_rule_simd(const R& rule, typename V::reg cells, typename V::reg ones, typename V::reg twos,
+                                           typename V::reg fours, typename V::reg eights, std::integer_sequence<int, N...>) {
+        typename V::reg next = V::zero();
+        ((next = V::bor(next, rule_term_simd<V, N>(rule, cells, ones, twos, fours, eights))), ...);
+        return next;
+    }
+
+    /**
+     * @brief Vector version of step_word() over a whole row.
+     *
+     * `V` wraps one instruction set (register type, loads, stores and bitwise
+     * operations on 64-bit lanes). It must be defined in the translation unit that
+     * instantiates this template, which is compiled with the matching `-m` flag.
+     * The words on both sides of the row must be readable (padding words).
+     *
+     * @return The number of words computed; the caller finishes the remaining ones.
+     */
+    template <typename V, typename R>
+    std::size_t step_row_simd(const std::uint64_t* above, const std::uint64_t* cells, const std::uint64_t* below,
+                              std::uint64_t* out, std::size_t words, const R& rule) {
+        using reg = typename V::reg;
+        std::size_t k = 0;
+        for(; k + V::lanes <= words; k += V::lanes){
+            reg a = V::load(above + k);
+            reg b = V::load(cells + k);
+            reg c = V::load(below + k);
+            reg aw = V::west(a, V::load(above + k - 1));
+            reg ae = V::east(a, V::load(above + k + 1));
+            reg bw = V::west(b, V::load(cells + k - 1));
+            reg be = V::east(b, V::load(cells + k + 1));
+            reg cw = V::west(c, V::load(below + k - 1));
+            reg ce = V::east(c, V::load(below + k + 1));
+
+            // Same adder tree as step_word().
+            reg partial = V::bxor(aw, a);
+            reg sumA = V::bxor(partial, ae);
+            reg carryA = V::bor(V::band(aw, a), V::band(partial, ae));
+            partial = V::bxor(cw, c);
+            reg sumC = V::bxor(partial, ce);
+            reg carryC = V::bor(V::band(cw, c), V::band(partial, ce));
+            reg sumB = V::bxor(bw, be);
+            reg carryB = V::band(bw, be);
+
+            partial = V::bxor(sumA, sumC);
+            reg ones = V::bxor(partial, sumB);
+            reg carryOnes = V::bor(V::band(sumA, sumC), V::band(partial, sumB));
+
+            partial = V::bxor(carryA, carryC);
+            reg twosPartial = V::bxor(partial, carryB);
+            reg carryTwos = V::bor(V::band(carryA, carryC), V::band(partial, carryB));
+            reg twos = V::bxor(twosPartial, carryOnes);
+            reg carryTwosLast = V::band(twosPartial, carryOnes);
+
+            reg fours = V::bxor(carryTwos, carryTwosLast);
+            reg eights = V::band(carryTwos, carryTwosLast);
+
+            V::store(out + k, apply_rule_simd<V>(rule, b, ones, twos, fours, eights, std::make_integer_sequence<int, 9>()));
+        }
+        return k;
+    }
+
+    /// Instantiates a vector row kernel for the runtime rule and every StaticRule alias.
+#define GLIFE_INSTANTIATE_ROW_KERNEL(kernel) \
+    template std::size_t kernel<Rule>(const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, std::uint64_t*, std::size_t, const Rule&); \
+    template std::size_t kernel<ConwayRule>(const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, std::uint64_t*, std::size_t, const Rule&); \
+    template std::size_t kernel<HighLifeRule>(const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, std::uint64_t*, std::size_t, const Rule&); \
+    template std::size_t kernel<DayAndNightRule>(const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, std::uint64_t*, std::size_t, const Rule&); \
+    template std::size_t kernel<SeedsRule>(const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, std::uint64_t*, std::size_t, const Rule&);
+}
+
+#endif // BIT_KERNEL_SIMD_H
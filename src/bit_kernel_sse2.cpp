@@ -0,0 +1,62 @@
+/*!
+ * SSE2 instantiation of the row kernel (2 words, 128 cells, per instruction),
+ * and the SSE2 character packer of the pattern loader.
+ * This file is compiled with `-msse2`.
+ */
+
+#include <emmintrin.h>
+
+#include <type_traits>
+
+#include "bit_kernel.h"
+#include "bit_kernel_simd.h"
+
+namespace life {
+    namespace {
+        /// SSE2 operations on two 64-bit lanes.
+        struct Sse2 {
+            using reg = __m128i;
+            static constexpr std::size_t lanes = 2;
+
+            static reg load(const std::uint64_t* p) {return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));}
+            static void store(std::uint64_t* p, reg v) {_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);}
+            static reg zero() {return _mm_setzero_si128();}
+            static reg ones() {return _mm_set1_epi32(-1);}
+            static reg band(reg a, reg b) {return _mm_and_si128(a, b);}
+            static reg bor(reg a, reg b) {return _mm_or_si128(a, b);}
+            static reg bxor(reg a, reg b) {return _mm_xor_si128(a, b);}
+            static reg bnot(reg a) {return _mm_xor_si128(a, ones());}
+            static reg andnot(reg a, reg b) {return _mm_andnot_si128(a, b);}
+            static reg west(reg x, reg left) {return _mm_or_si128(_mm_slli_epi64(x, 1), _mm_srli_epi64(left, 63));}
+            static reg east(reg x, reg right) {return _mm_or_si128(_mm_srli_epi64(x, 1), _mm_slli_epi64(right, 63));}
+        };
+    }
+
+    template <typename R>
+    std::size_t step_row_sse2(const std::uint64_t* above, const std::uint64_t* cells, const std::uint64_t* below,
+                              std::uint64_t* out, std::size_t words, const Rule& rule) {
+        // Kept local instead of using KernelRule, so no inline function shared with
+        // the portable code is compiled with this file's instruction set.
+        if constexpr (std::is_same_v<R, Rule>){
+            return step_row_simd<Sse2>(above, cells, below, out, words, rule);
+        }else{
+            return step_row_simd<Sse2>(above, cells, below, out, words, R{});
+        }
+    }
+
+    GLIFE_INSTANTIATE_ROW_KERNEL(step_row_sse2)
+
+    std::size_t pack_chars_sse2(const char* text, std::size_t words, char live, std::uint64_t* out) {
+        const __m128i wanted = _mm_set1_epi8(live);
+        for(std::size_t k = 0; k < words; k++){
+            std::uint64_t word = 0;
+            for(int part = 0; part < 4; part++){
+                __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + 64 * k + 16 * part));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, wanted)));
+                word |= static_cast<std::uint64_t>(mask) << (16 * part);
+            }
+            out[k] = word;
+        }
+        return words;
+    }
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <cstdlib>
+#include <utility>
+
+#include "change_engine.h"
+
+namespace life {
+
+/**
+ * @brief Creates an empty board.
+ *
+ * @param rows Number of rows of the board.
+ * @param cols Number of columns of the board.
+ * @param rule Birth and survival conditions. Births with zero neighbors (B0) are
+ *             not supported, since they happen away from any change.
+ */
+    ChangeEngine::ChangeEngine(int rows, int cols, const Rule& rule)
+        : m_rows(rows), m_cols(cols), m_width(static_cast<std::size_t>(cols) + 2) {
+        if(rule.born & 1u){
+            std::cerr << ">>> The changelist engine does not support births with zero neighbors (B0)!" << std::endl;
+            exit(1);
+        }
+
+        long width = static_cast<long>(m_width);
+        m_neighborOffsets = {-width - 1, -width, -width + 1, -1, 1, width - 1, width, width + 1};
+
+        for(int state = 0; state < 32; state++){
+            int count = state >> count_shift;
+            bool isAlive = state & alive_bit;
+            std::uint16_t conditions = isAlive ? rule.survive : rule.born;
+            m_nextState[state] = (count <= 8 && ((conditions >> count) & 1u)) ? alive_bit : 0;
+        }
+
+        m_cells.assign((static_cast<std::size_t>(rows) + 2) * m_width, 0);
+        m_words.assign(static_cast<std::size_t>(rows) * words_per_row(cols), 0);
+        for(std::size_t col = 0; col < m_width; col++){
+            m_cells[col] |= outside_bit;
+            m_cells[(static_cast<std::size_t>(rows) + 1) * m_width + col] |= outside_bit;
+        }
+        for(int row = 0; row < rows + 2; row++){
+            m_cells[row * m_width] |= outside_bit;
+            m_cells[row * m_width + m_width - 1] |= outside_bit;
+        }
+    }
+
+/**
+ * @brief Flips a cell and updates the neighbor counts and the fingerprint.
+ *
+ * @param cell Index of the cell.
+ */
+    void ChangeEngine::toggle(std::size_t cell) {
+        m_cells[cell] ^= alive_bit;
+        bool isAlive = m_cells[cell] & alive_bit;
+        m_population += isAlive ? 1 : -1;
+        std::size_t row = cell / m_width - 1;
+        std::size_t col = cell % m_width - 1;
+        std::size_t word = row * words_per_row(m_cols) + col / 64;
+        m_hash ^= zobrist_key(word, m_words[word]);
+        m_words[word] ^= std::uint64_t{1} << (col % 64);
+        m_hash ^= zobrist_key(word, m_words[word]);
+        for(long offset : m_neighborOffsets){
+            std::uint8_t& neighbor = m_cells[cell + offset];
+            neighbor = isAlive ? neighbor + (1u << count_shift) : neighbor - (1u << count_shift);
+        }
+    }
+
+/**
+ * @brief Sets a cell and records it as changed, so the next step looks around it.
+ */
+    void ChangeEngine::set(int row, int col, bool alive) {
+        std::size_t cell = index(row, col);
+        if(static_cast<bool>(m_cells[cell] & alive_bit) != alive){
+            toggle(cell);
+            m_changed.push_back(cell);
+        }
+    }
+
+/**
+ * @brief Advances the board one generation.
+ *
+ * The candidates are the changed cells and their neighbors, each taken once.
+ * All of them are evaluated against the current counts before any change is
+ * applied, so the update is simultaneous.
+ */
+    void ChangeEngine::step() {
+        m_candidates.clear();
+        for(std::size_t cell : m_changed){
+            for(long offset : {0L, m_neighborOffsets[0], m_neighborOffsets[1], m_neighborOffsets[2], m_neighborOffsets[3],
+                               m_neighborOffsets[4], m_neighborOffsets[5], m_neighborOffsets[6], m_neighborOffsets[7]}){
+                std::size_t candidate = cell + offset;
+                if((m_cells[candidate] & (queued_bit | outside_bit)) == 0){
+                    m_cells[candidate] |= queued_bit;
+                    m_candidates.push_back(candidate);
+                }
+            }
+        }
+
+        m_nextChanged.clear();
+        for(std::size_t cell : m_candidates){
+            std::uint8_t state = m_cells[cell] & ~queued_bit;
+            m_cells[cell] = state;
+            if(m_nextState[state] != (state & alive_bit)){
+                m_nextChanged.push_back(cell);
+            }
+        }
+
+        for(std::size_t cell : m_nextChanged){
+            toggle(cell);
+        }
+        std::swap(m_changed, m_nextChanged);
+    }
+
+}
@@ -0,0 +1,59 @@
+#ifndef CHANGE_ENGINE_H
+#define CHANGE_ENGINE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "engine.h"
+
+namespace life {
+    //! Engine that only visits the cells around last generation's changes.
+    /*!
+     * Every cell is a byte holding its state and its live neighbor count, and the
+     * engine keeps the list of cells that changed in the last step. A cell can only
+     * change if itself or a neighbor changed, so a step evaluates those cells only,
+     * and then updates the neighbor counts around the new changes. The cost of a
+     * generation grows with the activity on the board, not with its area.
+     */
+    class ChangeEngine : public Engine {
+        private:
+            static constexpr std::uint8_t alive_bit = 0x01;    //!< The cell is alive.
+            static constexpr std::uint8_t count_shift = 1;     //!< Neighbor count in bits 1 to 4.
+            static constexpr std::uint8_t queued_bit = 0x40;   //!< Already in this step's candidates.
+            static constexpr std::uint8_t outside_bit = 0x80;  //!< Padding cell around the board.
+
+            int m_rows;
+            int m_cols;
+            std::size_t m_width;                    //!< Row length, with one padding cell on each side.
+            std::array<long, 8> m_neighborOffsets;
+            std::array<std::uint8_t, 32> m_nextState; //!< Next alive bit, by alive bit and neighbor count.
+            std::vector<std::uint8_t> m_cells;
+            std::vector<std::size_t> m_changed;     //!< Cells that changed in the last step.
+            std::vector<std::size_t> m_candidates;
+            std::vector<std::size_t> m_nextChanged;
+            long m_population = 0;
+            std::vector<std::uint64_t> m_words;     //!< Live cells packed in the words of the fingerprint.
+            Hash128 m_hash;                         //!< Zobrist fingerprint, updated by every toggle.
+
+            std::size_t index(int row, int col) const {return (static_cast<std::size_t>(row) + 1) * m_width + col + 1;}
+            void toggle(std::size_t cell);
+
+        public:
+            ChangeEngine(int rows, int cols, const Rule& rule);
+
+            int rows() const override {return m_rows;}
+            int cols() const override {return m_cols;}
+            bool alive(int row, int col) const override {return m_cells[index(row, col)] & alive_bit;}
+            void set(int row, int col, bool alive) override;
+            void step() override;
+            long population() const override {return m_population;}
+            Hash128 state_hash() const override {return m_hash;}
+            ShapeHash shape_hash() const override {return packed_shape_hash(m_words.data(), words_per_row(m_cols), m_rows, m_cols);}
+            void pack(std::vector<std::uint64_t>& words) const override {words = m_words;}
+            std::unique_ptr<Engine> clone() const override {return std::make_unique<ChangeEngine>(*this);}
+    };
+}
+
+#endif // CHANGE_ENGINE_H
@@ -0,0 +1,209 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+namespace life {
+
+    namespace {
+        /// "GLIFECP2" read as a little-endian word.
+        constexpr std::uint64_t checkpoint_magic = 0x3250434546494c47ull;
+    }
+
+/**
+ * @brief Writes a checkpoint to a temporary file, then renames it over the old one.
+ *
+ * The file is a sequence of 64-bit words in the byte order of the machine: the
+ * magic number, rows, columns, generation, the rule (born | survive << 16), then
+ * the cells and the cycle detection history, each preceded by its length in words,
+ * and last the number of runs of spilled fingerprints, then each run preceded
+ * by its number of entries. Those are copied straight from the snapshots of
+ * the spill files, on the thread that writes.
+ * A run killed while writing leaves the previous checkpoint in place.
+ *
+ * A failure is reported but does not stop the run.
+ *
+ * @param path File to write.
+ * @param checkpoint State to write.
+ */
+    void write_checkpoint(const std::string& path, const Checkpoint& checkpoint) {
+        std::vector<std::uint64_t> header = {
+            checkpoint_magic,
+            static_cast<std::uint64_t>(checkpoint.rows),
+            static_cast<std::uint64_t>(checkpoint.cols),
+            static_cast<std::uint64_t>(checkpoint.generation),
+            checkpoint.rule.born | (static_cast<std::uint64_t>(checkpoint.rule.survive) << 16),
+            checkpoint.cells.size()
+        };
+        std::uint64_t cyclesSize = checkpoint.cycles.size();
+        std::uint64_t runCount = checkpoint.spilled.size();
+
+        std::string temporary = path + ".tmp";
+        std::FILE* file = std::fopen(temporary.c_str(), "wb");
+        bool written = file
+                    && std::fwrite(header.data(), sizeof(std::uint64_t), header.size(), file) == header.size()
+                    && std::fwrite(checkpoint.cells.data(), sizeof(std::uint64_t), checkpoint.cells.size(), file)
+                       == checkpoint.cells.size()
+                    && std::fwrite(&cyclesSize, sizeof(std::uint64_t), 1, file) == 1
+                    && std::fwrite(checkpoint.cycles.data(), sizeof(std::uint64_t), checkpoint.cycles.size(), file)
+                       == checkpoint.cycles.size()
+                    && std::fwrite(&runCount, sizeof(std::uint64_t), 1, file) == 1;
+        for(const std::shared_ptr<const HistoryFile::Snapshot>& run : checkpoint.spilled){
+            std::uint64_t runSize = run->size();
+            written = written
+                   && std::fwrite(&runSize, sizeof(std::uint64_t), 1, file) == 1
+                   && std::fwrite(run->entries(), sizeof(HistoryFile::Entry), runSize, file) == runSize;
+        }
+        written = written
+               && std::fflush(file) == 0
+                    && fsync(fileno(file)) == 0;
+        if(file && std::fclose(file) != 0){
+            written = false;
+        }
+        if(!written || std::rename(temporary.c_str(), path.c_str()) != 0){
+            std::cerr << ">>> Could not write the checkpoint " << path << "!" << std::endl;
+        }
+    }
+
+/**
+ * @brief Reads a checkpoint; the spilled fingerprints are mapped from the file instead of read.
+ *
+ * Every length is checked against what is left of the file before anything
+ * is allocated or mapped, so a damaged checkpoint is reported as such. A later
+ * checkpoint written to the same path replaces the file by a rename, which
+ * leaves the one mapped here in place.
+ *
+ * @param path File to read.
+ */
+    Checkpoint read_checkpoint(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if(!file){
+            std::cerr << ">>> Error opening the checkpoint " << path << "!" << std::endl;
+            exit(1);
+        }
+        auto fail = [&](){
+            std::fclose(file);
+            std::cerr << ">>> " << path << " is not a valid checkpoint!" << std::endl;
+            exit(1);
+        };
+        struct stat status;
+        if(fstat(fileno(file), &status) != 0){
+            fail();
+        }
+        std::uint64_t fileSize = static_cast<std::uint64_t>(status.st_size);
+        std::uint64_t position = 0;
+        auto read_items = [&](void* items, std::size_t itemSize, std::uint64_t count){
+            if(count > (fileSize - position) / itemSize
+               || std::fread(items, itemSize, count, file) != count){
+                fail();
+            }
+            position += count * itemSize;
+        };
+        auto read_words = [&](std::uint64_t* words, std::uint64_t count){
+            read_items(words, sizeof(std::uint64_t), count);
+        };
+
+        std::uint64_t header[6];
+        read_words(header, 6);
+        if(header[0] != checkpoint_magic){
+            fail();
+        }
+        Checkpoint checkpoint;
+        checkpoint.rows = static_cast<int>(header[1]);
+        checkpoint.cols = static_cast<int>(header[2]);
+        checkpoint.generation = static_cast<long>(header[3]);
+        checkpoint.rule.born = static_cast<std::uint16_t>(header[4] & 0xffffu);
+        checkpoint.rule.survive = static_cast<std::uint16_t>(header[4] >> 16);
+        if(checkpoint.rows <= 0 || checkpoint.cols <= 0
+           || header[5] != checkpoint.rows * words_per_row(checkpoint.cols)
+           || header[5] > (fileSize - position) / sizeof(std::uint64_t)){
+            fail();
+        }
+        checkpoint.cells.resize(header[5]);
+        read_words(checkpoint.cells.data(), checkpoint.cells.size());
+        std::uint64_t cyclesSize;
+        read_words(&cyclesSize, 1);
+        if(cyclesSize > (fileSize - position) / sizeof(std::uint64_t)){
+            fail();
+        }
+        checkpoint.cycles.resize(cyclesSize);
+        read_words(checkpoint.cycles.data(), checkpoint.cycles.size());
+        std::uint64_t runCount;
+        read_words(&runCount, 1);
+        for(std::uint64_t run = 0; run < runCount; run++){
+            std::uint64_t runSize;
+            read_words(&runSize, 1);
+            if(runSize > (fileSize - position) / sizeof(HistoryFile::Entry)){
+                fail();
+            }
+            if(runSize == 0){
+                continue;
+            }
+            int fd = dup(fileno(file));
+            if(fd < 0){
+                fail();
+            }
+            checkpoint.spilled.push_back(std::make_shared<const HistoryFile::Snapshot>(fd, runSize, position));
+            position += runSize * sizeof(HistoryFile::Entry);
+            if(std::fseek(file, static_cast<long>(position), SEEK_SET) != 0){
+                fail();
+            }
+        }
+        std::fclose(file);
+        return checkpoint;
+    }
+
+    CheckpointWriter::CheckpointWriter(std::string path) : m_path(std::move(path)) {
+        m_thread = std::thread(&CheckpointWriter::writer_loop, this);
+    }
+
+    CheckpointWriter::~CheckpointWriter() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+/**
+ * @brief Writes the waiting checkpoint whenever there is one, until stopped with none left.
+ */
+    void CheckpointWriter::writer_loop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(true){
+            m_wake.wait(lock, [this]{return m_hasPending || m_stop;});
+            if(!m_hasPending){
+                return;
+            }
+            Checkpoint checkpoint = std::move(m_pending);
+            m_hasPending = false;
+            m_writing = true;
+            lock.unlock();
+            write_checkpoint(m_path, checkpoint);
+            lock.lock();
+            m_writing = false;
+            m_done.notify_all();
+        }
+    }
+
+    void CheckpointWriter::submit(Checkpoint checkpoint) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending = std::move(checkpoint);
+            m_hasPending = true;
+        }
+        m_wake.notify_one();
+    }
+
+    void CheckpointWriter::flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]{return !m_hasPending && !m_writing;});
+    }
+
+}
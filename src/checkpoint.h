@@ -0,0 +1,75 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine.h"
+#include "history_file.h"
+
+namespace life {
+    /// State of a run, enough to go on with it later.
+    struct Checkpoint {
+        int rows = 0;
+        int cols = 0;
+        long generation = 0;                //!< Generation of the board.
+        Rule rule;
+        std::vector<std::uint64_t> cells;   //!< Board packed like Engine::pack().
+        std::vector<std::uint64_t> cycles;  //!< What the cycle detector recorded before the board, from CycleDetector::save().
+        HistoryFile::Runs spilled;          //!< Fingerprints from CycleDetector::spilled().
+    };
+
+    /**
+     * @brief Writes a checkpoint to a file, replacing it only once the new one is complete.
+     *
+     * @param path File to write.
+     * @param checkpoint State to write.
+     */
+    void write_checkpoint(const std::string& path, const Checkpoint& checkpoint);
+    /**
+     * @brief Reads a checkpoint written by write_checkpoint().
+     *
+     * @param path File to read.
+     */
+    Checkpoint read_checkpoint(const std::string& path);
+
+    //! Writes checkpoints on a thread of its own, so the simulation does not wait for the disk.
+    /*!
+     * Only the latest checkpoint matters: one submitted while the previous is
+     * still being written replaces any other waiting.
+     */
+    class CheckpointWriter {
+        private:
+            std::string m_path;
+            std::thread m_thread;
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            std::condition_variable m_done;
+            Checkpoint m_pending;
+            bool m_hasPending = false;
+            bool m_writing = false;
+            bool m_stop = false;
+
+            void writer_loop();
+
+        public:
+            explicit CheckpointWriter(std::string path);
+            ~CheckpointWriter();
+            CheckpointWriter(const CheckpointWriter&) = delete;
+            CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+            /// Queues a checkpoint to be written, and returns at once.
+            void submit(Checkpoint checkpoint);
+            /// Waits until every checkpoint submitted is written.
+            void flush();
+            /// File the checkpoints are written to.
+            const std::string& path() const {return m_path;}
+    };
+}
+
+#endif // CHECKPOINT_H
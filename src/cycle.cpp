@@ -0,0 +1,448 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+#include "cycle.h"
+
+namespace life {
+
+    namespace {
+        /// Next word of a checkpoint, which must have one more.
+        std::uint64_t next_word(const std::vector<std::uint64_t>& in, std::size_t& at) {
+            if(at >= in.size()){
+                std::cerr << ">>> The cycle detection history of the checkpoint is damaged!" << std::endl;
+                exit(1);
+            }
+            return in[at++];
+        }
+    }
+
+    StateTable::StateTable(std::size_t bytes, std::string directory)
+        : m_slots(1024), m_file(std::move(directory)) {
+        m_maxSlots = std::max<std::size_t>(m_slots.size(), bytes / sizeof(Slot));
+        if(bytes == 0){
+            m_maxSlots = static_cast<std::size_t>(-1);
+        }
+    }
+
+/**
+ * @brief Finds the slot holding a fingerprint, or the free slot where it belongs.
+ */
+    StateTable::Slot& StateTable::probe(const Hash128& hash) {
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t index = hash.low & mask;
+        while(m_slots[index].generation >= 0 && m_slots[index].hash != hash){
+            index = (index + 1) & mask;
+        }
+        return m_slots[index];
+    }
+
+/**
+ * @brief Doubles the number of slots and records every fingerprint again.
+ */
+    void StateTable::grow() {
+        std::vector<Slot> oldSlots(m_slots.size() * 2);
+        std::swap(oldSlots, m_slots);
+        for(const Slot& slot : oldSlots){
+            if(slot.generation >= 0){
+                probe(slot.hash) = slot;
+            }
+        }
+    }
+
+/**
+ * @brief Moves every fingerprint to the spill file and empties the table.
+ *
+ * The fingerprints are packed at the front of the slots and sorted there, so
+ * a spill needs no memory beyond the table.
+ */
+    void StateTable::spill() {
+        auto used = std::remove_if(m_slots.begin(), m_slots.end(), [](const Slot& slot){return slot.generation < 0;});
+        std::sort(m_slots.begin(), used, [](const Slot& a, const Slot& b){return HistoryFile::less(a.hash, b.hash);});
+        m_file.add(m_slots.data(), m_size);
+        std::fill(m_slots.begin(), m_slots.end(), Slot());
+        m_size = 0;
+    }
+
+    long StateTable::find_or_insert(const Hash128& hash, long generation) {
+        Slot& slot = probe(hash);
+        if(slot.generation >= 0){
+            return slot.generation;
+        }
+        long spilled = m_file.find(hash);
+        if(spilled >= 0){
+            return spilled;
+        }
+        slot.hash = hash;
+        slot.generation = generation;
+        if(++m_size * 2 > m_slots.size()){
+            if(m_slots.size() * 2 <= m_maxSlots){
+                grow();
+            }else{
+                spill();
+            }
+        }
+        return -1;
+    }
+
+/**
+ * @brief Fingerprints a board: its state_hash(), or its shape_hash() when translations are allowed.
+ */
+    CycleDetector::Fingerprint CycleDetector::fingerprint(const Engine& engine) const {
+        if(m_translations){
+            return engine.shape_hash();
+        }
+        Fingerprint print;
+        print.hash = engine.state_hash();
+        return print;
+    }
+
+/**
+ * @brief Tells whether a later board repeats an earlier one, moved by the offset of their fingerprints.
+ *
+ * The fingerprints are compared first, then every cell of the later board with
+ * the cell it comes from; equal populations make sure no live cell was moved off
+ * the board.
+ */
+    bool CycleDetector::same_board(const Engine& earlier, const Fingerprint& earlierPrint,
+                                   const Engine& later, const Fingerprint& laterPrint) const {
+        if(earlierPrint.hash != laterPrint.hash || earlier.population() != later.population()){
+            return false;
+        }
+        int shiftRows = laterPrint.top - earlierPrint.top;
+        int shiftCols = laterPrint.left - earlierPrint.left;
+        for(int row = 0; row < later.rows(); row++){
+            for(int col = 0; col < later.cols(); col++){
+                int fromRow = row - shiftRows;
+                int fromCol = col - shiftCols;
+                bool inside = fromRow >= 0 && fromRow < earlier.rows() && fromCol >= 0 && fromCol < earlier.cols();
+                if(later.alive(row, col) != (inside && earlier.alive(fromRow, fromCol))){
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+/**
+ * @brief Keeps a copy of the board if it is the first one recorded.
+ */
+    void CycleDetector::remember_first(const Engine& engine, long generation) {
+        if(!m_first){
+            m_first = engine.clone();
+            m_firstGeneration = generation;
+        }
+    }
+
+/**
+ * @brief Copies the first board recorded and advances the copy to a later generation.
+ */
+    std::unique_ptr<Engine> CycleDetector::replay(long generation) const {
+        std::unique_ptr<Engine> copy = m_first->clone();
+        advance_exactly(*copy, generation - m_firstGeneration);
+        return copy;
+    }
+
+/**
+ * @brief Finds the first generation of the cycle, its shortest period and how far it moves.
+ *
+ * Two copies of the first board, `period` generations apart, are stepped
+ * together until they match, which happens first at the start of the cycle.
+ * When the boards were recorded more than one generation apart, `period` may be
+ * a multiple of the shortest one, which is then found by stepping a copy of the
+ * first board of the cycle until it comes back.
+ *
+ * @param period Generations between two matching boards.
+ */
+    void CycleDetector::locate(long period) {
+        std::unique_ptr<Engine> slow = m_first->clone();
+        std::unique_ptr<Engine> fast = replay(m_firstGeneration + period);
+        long start = m_firstGeneration;
+        while(!same_board(*slow, fingerprint(*slow), *fast, fingerprint(*fast))){
+            advance_exactly(*slow, 1);
+            advance_exactly(*fast, 1);
+            start++;
+        }
+
+        Fingerprint first = fingerprint(*slow);
+        Fingerprint last = fingerprint(*fast);
+        std::unique_ptr<Engine> probe = slow->clone();
+        long shortest = period;
+        for(long steps = 1; steps < period; steps++){
+            advance_exactly(*probe, 1);
+            Fingerprint print = fingerprint(*probe);
+            if(same_board(*slow, first, *probe, print)){
+                shortest = steps;
+                last = print;
+                break;
+            }
+        }
+        m_start = start;
+        m_period = shortest;
+        m_shiftRows = last.top - first.top;
+        m_shiftCols = last.left - first.left;
+    }
+
+/**
+ * @brief Advances an engine exactly the given number of generations, even if it jumps ahead.
+ */
+    void CycleDetector::advance_exactly(Engine& engine, long generations) {
+        for(long done = 0; done < generations; ){
+            done += engine.advance(generations - done);
+        }
+    }
+
+/**
+ * @brief Appends a board to a checkpoint: its number of words, then the words of pack().
+ *
+ * @param board Board to save; null for none, saved as zero words.
+ */
+    void CycleDetector::save_board(const Engine* board, std::vector<std::uint64_t>& out) {
+        std::vector<std::uint64_t> words;
+        if(board){
+            board->pack(words);
+        }
+        out.push_back(words.size());
+        out.insert(out.end(), words.begin(), words.end());
+    }
+
+/**
+ * @brief Reads a board saved by save_board() into a copy of an engine.
+ *
+ * @return The board, or null if none was saved.
+ */
+    std::unique_ptr<Engine> CycleDetector::load_board(const std::vector<std::uint64_t>& in, std::size_t& at,
+                                                      const Engine& engine) {
+        std::size_t size = next_word(in, at);
+        if(size == 0){
+            return nullptr;
+        }
+        if(size != engine.rows() * words_per_row(engine.cols()) || in.size() - at < size){
+            std::cerr << ">>> The cycle detection history of the checkpoint is damaged!" << std::endl;
+            exit(1);
+        }
+        std::unique_ptr<Engine> board = engine.clone();
+        board->unpack(std::vector<std::uint64_t>(in.begin() + at, in.begin() + at + size));
+        at += size;
+        return board;
+    }
+
+/**
+ * @brief Saves the method, the first board and what the method recorded since.
+ *
+ * The first board is kept with the fingerprints, since a repeat found after the
+ * run is resumed may still be located by replaying it.
+ */
+    void CycleDetector::save(std::vector<std::uint64_t>& out) const {
+        out.push_back(method());
+        out.push_back(m_translations);
+        out.push_back(static_cast<std::uint64_t>(m_firstGeneration));
+        save_board(m_first.get(), out);
+        save_state(out);
+    }
+
+    bool CycleDetector::load(const std::vector<std::uint64_t>& in, const HistoryFile::Runs& spilled,
+                             const Engine& engine) {
+        std::size_t at = 0;
+        if(next_word(in, at) != method() || next_word(in, at) != static_cast<std::uint64_t>(m_translations)){
+            return false;
+        }
+        m_firstGeneration = static_cast<long>(next_word(in, at));
+        m_first = load_board(in, at, engine);
+        load_state(in, at, spilled, engine);
+        return true;
+    }
+
+/**
+ * @brief Saves the fingerprints held in memory, then the keyframes.
+ *
+ * Those in the spill file are left to spilled(), so the checkpoint writer can
+ * copy them from the file instead of the simulation copying them here.
+ */
+    void TableCycleDetector::save_state(std::vector<std::uint64_t>& out) const {
+        out.push_back(m_seen.memory_size());
+        m_seen.for_each([&out](const Hash128& hash, long generation){
+            out.push_back(hash.low);
+            out.push_back(hash.high);
+            out.push_back(static_cast<std::uint64_t>(generation));
+        });
+        out.push_back(static_cast<std::uint64_t>(m_lastGeneration));
+        out.push_back(m_everyGeneration);
+        out.push_back(static_cast<std::uint64_t>(m_keyframeGap));
+        out.push_back(m_keyframes.size());
+        for(const Keyframe& keyframe : m_keyframes){
+            out.push_back(static_cast<std::uint64_t>(keyframe.generation));
+            save_board(keyframe.board.get(), out);
+        }
+    }
+
+    void TableCycleDetector::load_state(const std::vector<std::uint64_t>& in, std::size_t& at,
+                                        const HistoryFile::Runs& spilled, const Engine& engine) {
+        m_seen.load_spilled(spilled);
+        std::size_t count = next_word(in, at);
+        for(std::size_t index = 0; index < count; index++){
+            Hash128 hash;
+            hash.low = next_word(in, at);
+            hash.high = next_word(in, at);
+            m_seen.find_or_insert(hash, static_cast<long>(next_word(in, at)));
+        }
+        if(at == in.size()){
+            m_everyGeneration = false;      // Saved before the keyframes were: the stride is unknown.
+            return;
+        }
+        m_lastGeneration = static_cast<long>(next_word(in, at));
+        m_everyGeneration = next_word(in, at) != 0;
+        m_keyframeGap = std::max(1L, static_cast<long>(next_word(in, at)));
+        std::size_t keyframes = std::min<std::size_t>(next_word(in, at), max_keyframes);
+        m_keyframes.clear();
+        for(std::size_t index = 0; index < keyframes; index++){
+            long generation = static_cast<long>(next_word(in, at));
+            std::unique_ptr<Engine> board = load_board(in, at, engine);
+            if(board){
+                m_keyframes.push_back({generation, std::move(board)});
+            }
+        }
+    }
+
+/**
+ * @brief Keeps a copy of the board when it is due, thinning the copies kept when there are too many.
+ */
+    void TableCycleDetector::keep_keyframe(const Engine& engine, long generation) {
+        if(!m_keyframes.empty() && generation - m_keyframes.back().generation < m_keyframeGap){
+            return;
+        }
+        if(m_keyframes.size() == max_keyframes){
+            for(std::size_t index = 1; 2 * index < m_keyframes.size(); index++){
+                m_keyframes[index] = std::move(m_keyframes[2 * index]);
+            }
+            m_keyframes.resize(max_keyframes / 2);
+            m_keyframeGap *= 2;
+        }
+        m_keyframes.push_back({generation, engine.clone()});
+    }
+
+/**
+ * @brief Builds the board of an earlier generation from the nearest board kept before it.
+ */
+    std::unique_ptr<Engine> TableCycleDetector::board_at(long generation) const {
+        auto after = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), generation,
+                                      [](long wanted, const Keyframe& keyframe){return wanted < keyframe.generation;});
+        if(after == m_keyframes.begin()){
+            return replay(generation);
+        }
+        std::unique_ptr<Engine> board = (after - 1)->board->clone();
+        advance_exactly(*board, generation - (after - 1)->generation);
+        return board;
+    }
+
+/**
+ * @brief Records the board of a generation and checks it against the earlier ones.
+ *
+ * The earlier board is restored from the archive when it holds that generation;
+ * an archive board that does not match, as when the engine keeps cells beyond
+ * the packed window, is checked again against one built from a keyframe.
+ *
+ * @param engine Engine holding the board.
+ * @param generation Generation of the board.
+ * @return True if the board repeats an earlier generation.
+ */
+    bool TableCycleDetector::repeated(const Engine& engine, long generation) {
+        remember_first(engine, generation);
+        if(m_lastGeneration >= 0 && generation - m_lastGeneration != 1){
+            m_everyGeneration = false;
+        }
+        m_lastGeneration = generation;
+        Fingerprint print = fingerprint(engine);
+        long earlier = m_seen.find_or_insert(print.hash, generation);
+        if(earlier < 0){
+            keep_keyframe(engine, generation);
+            return false;
+        }
+
+        std::unique_ptr<Engine> board;
+        Fingerprint earlierPrint;
+        if(m_archive){
+            board = engine.clone();
+            if(m_archive->restore(earlier, *board) == earlier){
+                earlierPrint = fingerprint(*board);
+            }else{
+                board.reset();
+            }
+        }
+        if(!board || !same_board(*board, earlierPrint, engine, print)){
+            board = board_at(earlier);
+            earlierPrint = fingerprint(*board);
+            if(!same_board(*board, earlierPrint, engine, print)){
+                keep_keyframe(engine, generation);
+                return false;
+            }
+        }
+
+        if(!m_everyGeneration){
+            locate(generation - earlier);
+            return true;
+        }
+        m_start = earlier;
+        m_period = generation - earlier;
+        m_shiftRows = print.top - earlierPrint.top;
+        m_shiftCols = print.left - earlierPrint.left;
+        return true;
+    }
+
+/**
+ * @brief Compares the board with the saved one, and moves the saved board forward when due.
+ *
+ * @param engine Engine holding the board.
+ * @param generation Generation of the board.
+ * @return True if the board repeats the saved one.
+ */
+    bool BrentCycleDetector::repeated(const Engine& engine, long generation) {
+        remember_first(engine, generation);
+        Fingerprint print = fingerprint(engine);
+        if(m_saved && same_board(*m_saved, m_savedPrint, engine, print)){
+            locate(generation - m_savedGeneration);
+            return true;
+        }
+        if(!m_saved || generation - m_savedGeneration >= m_power){
+            if(m_saved){
+                m_power *= 2;
+            }
+            m_saved = engine.clone();
+            m_savedPrint = print;
+            m_savedGeneration = generation;
+        }
+        return false;
+    }
+
+/**
+ * @brief Saves the saved board, its generation and the distance before it moves again.
+ */
+    void BrentCycleDetector::save_state(std::vector<std::uint64_t>& out) const {
+        out.push_back(static_cast<std::uint64_t>(m_savedGeneration));
+        out.push_back(static_cast<std::uint64_t>(m_power));
+        save_board(m_saved.get(), out);
+    }
+
+    void BrentCycleDetector::load_state(const std::vector<std::uint64_t>& in, std::size_t& at,
+                                        const HistoryFile::Runs&, const Engine& engine) {
+        m_savedGeneration = static_cast<long>(next_word(in, at));
+        m_power = static_cast<long>(next_word(in, at));
+        m_saved = load_board(in, at, engine);
+        if(m_saved){
+            m_savedPrint = fingerprint(*m_saved);
+        }
+    }
+
+    std::unique_ptr<CycleDetector> make_cycle_detector(const CycleOptions& options) {
+        if(options.method == "table"){
+            return std::make_unique<TableCycleDetector>(options);
+        }
+        if(options.method == "brent"){
+            return std::make_unique<BrentCycleDetector>(options.translations);
+        }
+        std::cerr << ">>> Unknown cycle detection \"" << options.method << "\"!" << std::endl;
+        exit(1);
+    }
+
+}
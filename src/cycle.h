@@ -0,0 +1,240 @@
+#ifndef CYCLE_H
+#define CYCLE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "archive.h"
+#include "engine.h"
+#include "history_file.h"
+#include "state_hash.h"
+
+namespace life {
+    /// Cycle detection options read from the configuration file.
+    struct CycleOptions {
+        std::string method = "table";      //!< "table" (fingerprint of every generation) or "brent" (constant memory).
+        bool translations = false;          //!< Whether a board moved from an earlier one also counts as a repeat.
+        std::size_t historyBytes = 0;       //!< Memory for the fingerprints of the table method; zero for no limit.
+        std::string historyDirectory;       //!< Where fingerprints past the limit go; empty for the temporary directory.
+    };
+
+    //! Open-addressing table from board fingerprints to the generation they were seen.
+    /*!
+     * Slots are probed linearly from the low word of the fingerprint, and the
+     * table doubles before it gets half full, so each generation costs about
+     * 48 bytes, whatever the size of the board.
+     *
+     * With a memory limit, a table that cannot double any more spills its
+     * fingerprints to a HistoryFile and starts over empty, so recent
+     * generations are found in memory and older ones on disk.
+     */
+    class StateTable {
+        private:
+            /// A fingerprint and its generation, laid out as on disk so a spill sorts the slots in place; free while negative.
+            using Slot = HistoryFile::Entry;
+
+            std::vector<Slot> m_slots;
+            std::size_t m_size = 0;
+            std::size_t m_maxSlots;     //!< Most slots the memory limit allows.
+            HistoryFile m_file;
+
+            Slot& probe(const Hash128& hash);
+            void grow();
+            void spill();
+
+        public:
+            /**
+             * @param bytes Memory for the slots; zero for no limit.
+             * @param directory Where the spill file is created; empty for the temporary directory.
+             */
+            explicit StateTable(std::size_t bytes = 0, std::string directory = "");
+
+            /**
+             * @brief Looks a fingerprint up, recording it if it is new.
+             *
+             * @return The generation the fingerprint was first recorded at, or -1 if it is new.
+             */
+            long find_or_insert(const Hash128& hash, long generation);
+            /// Number of fingerprints recorded, in memory and on disk.
+            std::size_t size() const {return m_size + m_file.size();}
+            /// Number of fingerprints held in memory.
+            std::size_t memory_size() const {return m_size;}
+
+            /// Calls `visit(hash, generation)` for every fingerprint held in memory.
+            template <typename F>
+            void for_each(F&& visit) const {
+                for(const Slot& slot : m_slots){
+                    if(slot.generation >= 0){
+                        visit(slot.hash, slot.generation);
+                    }
+                }
+            }
+            /// Fingerprints spilled to disk, as they are now.
+            HistoryFile::Runs spilled() const {return m_file.runs();}
+            /// Puts fingerprints on disk, as if spilled; the table must be empty.
+            void load_spilled(const HistoryFile::Runs& spilled) {m_file.adopt(spilled);}
+    };
+
+    //! Stops the simulation when the board repeats an earlier generation.
+    /*!
+     * Detectors keep a copy of the first board recorded, and replay it to
+     * confirm a cycle cell by cell, so a hash collision cannot end the run, and
+     * to find its exact start and period, even when the boards were recorded
+     * several generations apart.
+     *
+     * When translations are allowed, boards are compared by their shape_hash(),
+     * so a board that repeats an earlier one moved by some rows and columns (a
+     * spaceship) is a cycle too, and shift_rows() and shift_cols() tell how far
+     * it moves in each period.
+     */
+    class CycleDetector {
+        protected:
+            /// Fingerprint of a board and, when translations are allowed, the corner of its bounding box.
+            using Fingerprint = ShapeHash;
+
+            bool m_translations;
+            const StateArchive* m_archive = nullptr;    //!< Boards of the run, when kept; see use_archive().
+            std::unique_ptr<Engine> m_first;    //!< Copy of the first board recorded.
+            long m_firstGeneration = 0;
+            long m_start = -1;
+            long m_period = 0;
+            int m_shiftRows = 0;
+            int m_shiftCols = 0;
+
+            explicit CycleDetector(bool translations) : m_translations(translations) {}
+
+            Fingerprint fingerprint(const Engine& engine) const;
+            bool same_board(const Engine& earlier, const Fingerprint& earlierPrint,
+                            const Engine& later, const Fingerprint& laterPrint) const;
+            void remember_first(const Engine& engine, long generation);
+            std::unique_ptr<Engine> replay(long generation) const;
+            void locate(long period);
+            static void advance_exactly(Engine& engine, long generations);
+            static void save_board(const Engine* board, std::vector<std::uint64_t>& out);
+            static std::unique_ptr<Engine> load_board(const std::vector<std::uint64_t>& in, std::size_t& at,
+                                                      const Engine& engine);
+            virtual void save_state(std::vector<std::uint64_t>& out) const = 0;
+            virtual void load_state(const std::vector<std::uint64_t>& in, std::size_t& at,
+                                    const HistoryFile::Runs& spilled, const Engine& engine) = 0;
+            virtual std::uint64_t method() const = 0;
+
+        public:
+            virtual ~CycleDetector() = default;
+
+            /// Lets the detector take earlier boards from an archive of the run instead of simulating them again.
+            void use_archive(const StateArchive* archive) {m_archive = archive;}
+
+            /**
+             * @brief Records the board of a generation.
+             *
+             * Generations must be recorded in increasing order, from the same engine.
+             * @return True once a cycle is found; start() and period() then describe it.
+             */
+            virtual bool repeated(const Engine& engine, long generation) = 0;
+            /**
+             * @brief Appends what the detector has recorded in memory to a checkpoint.
+             *
+             * @param out Words of the checkpoint.
+             */
+            void save(std::vector<std::uint64_t>& out) const;
+            /// Fingerprints the detector has spilled to disk, which save() leaves out.
+            virtual HistoryFile::Runs spilled() const {return {};}
+            /**
+             * @brief Restores what a detector of the same method recorded, from a checkpoint.
+             *
+             * @param in Words saved by save().
+             * @param spilled Fingerprints from spilled().
+             * @param engine Engine the boards are recorded from.
+             * @return False if the words come from another method, which leaves the detector empty.
+             */
+            bool load(const std::vector<std::uint64_t>& in, const HistoryFile::Runs& spilled, const Engine& engine);
+            /// First generation of the cycle found, or -1.
+            long start() const {return m_start;}
+            /// Generations in the cycle found, or zero.
+            long period() const {return m_period;}
+            /// Rows the board moves down in each period of the cycle found.
+            int shift_rows() const {return m_shiftRows;}
+            /// Columns the board moves right in each period of the cycle found.
+            int shift_cols() const {return m_shiftCols;}
+    };
+
+    //! Records the fingerprint of every generation, and stops at the first repeated board.
+    /*!
+     * A fingerprint seen before is confirmed against the board of the earlier
+     * generation, taken from the archive of the run when there is one, or else
+     * simulated again from the nearest keyframe: a copy of the board kept every
+     * so often. At most `max_keyframes` are kept; when there would be more, every
+     * other one is dropped and the gap between them doubles.
+     *
+     * When every generation was recorded, the earlier generation is the start of
+     * the cycle and the distance to it its period. Only when engines jump ahead
+     * is the cycle located again from the first board.
+     */
+    class TableCycleDetector : public CycleDetector {
+        private:
+            struct Keyframe {
+                long generation;
+                std::unique_ptr<Engine> board;
+            };
+
+            static constexpr std::size_t max_keyframes = 32;
+
+            StateTable m_seen;
+            std::vector<Keyframe> m_keyframes;
+            long m_keyframeGap = 64;
+            long m_lastGeneration = -1;
+            bool m_everyGeneration = true;  //!< Whether no generation was skipped since the first one.
+
+            void keep_keyframe(const Engine& engine, long generation);
+            std::unique_ptr<Engine> board_at(long generation) const;
+
+            void save_state(std::vector<std::uint64_t>& out) const override;
+            void load_state(const std::vector<std::uint64_t>& in, std::size_t& at,
+                            const HistoryFile::Runs& spilled, const Engine& engine) override;
+            std::uint64_t method() const override {return 1;}
+
+        public:
+            explicit TableCycleDetector(const CycleOptions& options)
+                : CycleDetector(options.translations), m_seen(options.historyBytes, options.historyDirectory) {}
+
+            HistoryFile::Runs spilled() const override {return m_seen.spilled();}
+
+            bool repeated(const Engine& engine, long generation) override;
+    };
+
+    //! Brent's cycle detection: compares each board with a single saved board.
+    /*!
+     * The saved board moves to the current one whenever the distance between them
+     * reaches the next power of two, so memory does not grow with the run. The
+     * cycle is noticed up to about twice as many generations after it starts as
+     * with TableCycleDetector.
+     */
+    class BrentCycleDetector : public CycleDetector {
+        private:
+            std::unique_ptr<Engine> m_saved;
+            Fingerprint m_savedPrint;
+            long m_savedGeneration = 0;
+            long m_power = 1;
+
+            void save_state(std::vector<std::uint64_t>& out) const override;
+            void load_state(const std::vector<std::uint64_t>& in, std::size_t& at,
+                            const HistoryFile::Runs& spilled, const Engine& engine) override;
+            std::uint64_t method() const override {return 2;}
+
+        public:
+            explicit BrentCycleDetector(bool translations) : CycleDetector(translations) {}
+
+            bool repeated(const Engine& engine, long generation) override;
+    };
+
+    /**
+     * @brief Creates the cycle detector selected in the configuration.
+     *
+     * @param options Detection method and its settings.
+     */
+    std::unique_ptr<CycleDetector> make_cycle_detector(const CycleOptions& options = CycleOptions());
+}
+
+#endif // CYCLE_H
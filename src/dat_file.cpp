@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dat_file.h"
+#include "bit_kernel.h"
+#include "state_hash.h"
+#include "thread_pool.h"
+
+namespace life {
+
+/**
+ * @brief Reads a .dat file mapped in memory, converting its rows on every core.
+ *
+ * The rows are found with memchr, then packed in bands of rows by the threads of
+ * a pool, each row straight from the mapped file with pack_chars(). Only the
+ * first `cols` characters of a line count; a shorter line, or a missing one,
+ * reads as if padded with '.'.
+ *
+ * @param path File to read.
+ * @return The board, with the size and live character of the header.
+ */
+    DatPattern read_dat(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if(fd < 0 || fstat(fd, &info) != 0){
+            std::cerr << ">>> Error opening the matrix initiation file! " << path << std::endl;
+            exit(1);
+        }
+        std::size_t size = static_cast<std::size_t>(info.st_size);
+        void* mapped = (size == 0) ? MAP_FAILED : mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(mapped == MAP_FAILED){
+            std::cerr << ">>> Error mapping the matrix initiation file! " << path << std::endl;
+            exit(1);
+        }
+        madvise(mapped, size, MADV_WILLNEED);
+
+        const char* at = static_cast<const char*>(mapped);
+        const char* end = at + size;
+        // Moves `at` past the next line and returns the line, without its '\n'.
+        auto next_line = [&at, end](std::size_t& length){
+            const char* line = at;
+            const char* newline = static_cast<const char*>(std::memchr(at, '\n', end - at));
+            length = (newline ? newline : end) - line;
+            at = newline ? newline + 1 : end;
+            return line;
+        };
+
+        DatPattern pattern;
+        std::size_t length;
+        const char* line = next_line(length);
+        std::string header(line, length);
+        std::size_t spacePos = header.find(' ');
+        pattern.rows = std::stoi(header.substr(0, spacePos));
+        pattern.cols = std::stoi(header.substr(spacePos + 1));
+        line = next_line(length);
+        pattern.liveChar = (length > 0) ? line[0] : '\0';
+
+        std::vector<const char*> starts(pattern.rows, nullptr);
+        std::vector<std::size_t> lengths(pattern.rows, 0);
+        for(int row = 0; row < pattern.rows && at != end; row++){
+            starts[row] = next_line(lengths[row]);
+        }
+
+        std::size_t stride = words_per_row(pattern.cols);
+        pattern.cells.assign(pattern.rows * stride, 0);
+        const int band = 256;
+        ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+        pool.parallel_for((pattern.rows + band - 1) / band, [&](int task){
+            int last = std::min(pattern.rows, (task + 1) * band);
+            for(int row = task * band; row < last; row++){
+                std::uint64_t* cells = pattern.cells.data() + row * stride;
+                std::size_t count = std::min<std::size_t>(lengths[row], pattern.cols);
+                pack_chars(starts[row], count, pattern.liveChar, cells);
+                if(pattern.liveChar == '.'){
+                    for(std::size_t col = count; col < static_cast<std::size_t>(pattern.cols); col++){
+                        cells[col / 64] |= std::uint64_t{1} << (col % 64);
+                    }
+                }
+            }
+        });
+        munmap(mapped, size);
+        return pattern;
+    }
+
+}
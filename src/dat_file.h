@@ -0,0 +1,25 @@
+#ifndef DAT_FILE_H
+#define DAT_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace life {
+    /// Board read from a .dat file.
+    struct DatPattern {
+        int rows = 0;
+        int cols = 0;
+        char liveChar = '*';                //!< Character of a live cell, from the second line.
+        std::vector<std::uint64_t> cells;   //!< Board packed like Engine::pack().
+    };
+
+    /**
+     * @brief Reads a pattern in the .dat format: "rows cols", the live character, then one line per row.
+     *
+     * @param path File to read.
+     */
+    DatPattern read_dat(const std::string& path);
+}
+
+#endif // DAT_FILE_H
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+#include "engine.h"
+#include "scalar_engine.h"
+#include "bit_engine.h"
+#include "bit_kernel.h"
+#include "change_engine.h"
+#include "hashlife_engine.h"
+#include "tile_engine.h"
+#include "lut_engine.h"
+
+namespace life {
+
+/**
+ * @brief Fingerprints the board by scanning every cell.
+ *
+ * @return The XOR of the Zobrist keys of the words of the board.
+ */
+    Hash128 Engine::state_hash() const {
+        Hash128 hash;
+        std::size_t words = words_per_row(cols());
+        for(int row = 0; row < rows(); row++){
+            for(std::size_t k = 0; k < words; k++){
+                std::uint64_t cells = 0;
+                for(int bit = 0; bit < 64 && static_cast<int>(64 * k) + bit < cols(); bit++){
+                    cells |= static_cast<std::uint64_t>(alive(row, static_cast<int>(64 * k) + bit)) << bit;
+                }
+                hash ^= zobrist_key(row * words + k, cells);
+            }
+        }
+        return hash;
+    }
+
+/**
+ * @brief Packs the board through alive() and fingerprints it relative to its bounding box.
+ */
+    ShapeHash Engine::shape_hash() const {
+        std::vector<std::uint64_t> cells;
+        pack(cells);
+        return packed_shape_hash(cells.data(), words_per_row(cols()), rows(), cols());
+    }
+
+    Hash128 Engine::canonical_hash() const {
+        std::vector<std::uint64_t> cells;
+        pack(cells);
+        return packed_canonical_hash(cells.data(), words_per_row(cols()), rows(), cols());
+    }
+
+    void Engine::pack(std::vector<std::uint64_t>& words) const {
+        std::size_t stride = words_per_row(cols());
+        words.assign(rows() * stride, 0);
+        for(int row = 0; row < rows(); row++){
+            for(int col = 0; col < cols(); col++){
+                words[row * stride + col / 64] |= static_cast<std::uint64_t>(alive(row, col)) << (col % 64);
+            }
+        }
+    }
+
+    void Engine::unpack(const std::vector<std::uint64_t>& words) {
+        std::size_t stride = words_per_row(cols());
+        for(int row = 0; row < rows(); row++){
+            for(int col = 0; col < cols(); col++){
+                set(row, col, (words[row * stride + col / 64] >> (col % 64)) & 1u);
+            }
+        }
+    }
+
+/**
+ * @brief Creates the stepping engine selected in the configuration.
+ *
+ * @param name Engine name: "bitgrid" (bit-packed, default), "changelist" (cells near the
+ *             last changes only), "hashlife" (memoized quadtree), "tiles" (unbounded
+ *             universe of 64x64 tiles), "lut" (2x2 blocks from a lookup table) or
+ *             "scalar" (one cell at a time).
+ * @param rows Number of rows of the board.
+ * @param cols Number of columns of the board.
+ * @param rule Birth and survival conditions.
+ * @param options Engine tuning options. Topologies other than the plane need the bitgrid engine.
+ * @return The engine, holding an empty board.
+ */
+    std::unique_ptr<Engine> make_engine(const std::string& name, int rows, int cols, const Rule& rule,
+                                        const EngineOptions& options){
+        Topology topology;
+        if(options.topology == "plane"){
+            topology = Topology::plane;
+        }else if(options.topology == "torus"){
+            topology = Topology::torus;
+        }else if(options.topology == "klein"){
+            topology = Topology::klein;
+        }else if(options.topology == "cylinder"){
+            topology = Topology::cylinder;
+        }else{
+            std::cerr << ">>> Unknown topology \"" << options.topology << "\"!" << std::endl;
+            exit(1);
+        }
+        if(topology != Topology::plane && name != "bitgrid"){
+            std::cerr << ">>> The " << options.topology << " topology needs the bitgrid engine!" << std::endl;
+            exit(1);
+        }
+
+        if(name == "bitgrid"){
+            return std::make_unique<BitEngine>(rows, cols, rule, select_row_kernel(options.kernel, rule), options.threads, topology);
+        }
+        if(name == "changelist"){
+            return std::make_unique<ChangeEngine>(rows, cols, rule);
+        }
+        if(name == "hashlife"){
+            return std::make_unique<HashLifeEngine>(rows, cols, rule);
+        }
+        if(name == "tiles"){
+            return std::make_unique<TileEngine>(rows, cols, rule);
+        }
+        if(name == "lut"){
+            return std::make_unique<LutEngine>(rows, cols, rule);
+        }
+        if(name == "scalar"){
+            return std::make_unique<ScalarEngine>(rows, cols, rule);
+        }
+        std::cerr << ">>> Unknown engine \"" << name << "\"!" << std::endl;
+        exit(1);
+    }
+
+}
@@ -0,0 +1,97 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "state_hash.h"
+
+namespace life {
+    /// Birth and survival conditions as 9-bit masks: bit `n` set means "n live neighbors".
+    struct Rule {
+        std::uint16_t born = 1u << 3;
+        std::uint16_t survive = (1u << 2) | (1u << 3);
+    };
+
+    /// Tuning options read from the configuration file.
+    struct EngineOptions {
+        std::string kernel = "auto";    //!< Row kernel of the bit-packed engine: auto, scalar, sse2 or avx2.
+        int threads = 1;                //!< Threads stepping the board; zero uses every core.
+        std::string topology = "plane"; //!< Board edges: plane, torus, klein or cylinder.
+    };
+
+    //! Stepping engine interface.
+    /*!
+     * An engine owns the grid storage and knows how to advance it one generation.
+     * Coordinates are zero-based and cover only the `rows() x cols()` interior of
+     * the board; every cell outside of it is considered dead.
+     */
+    class Engine {
+        public:
+            virtual ~Engine() = default;
+
+            /// Number of rows of the board.
+            virtual int rows() const = 0;
+            /// Number of columns of the board.
+            virtual int cols() const = 0;
+            /// Tells whether the cell at (row, col) is alive.
+            virtual bool alive(int row, int col) const = 0;
+            /// Sets the state of the cell at (row, col).
+            virtual void set(int row, int col, bool alive) = 0;
+            /// Advances the board one generation.
+            virtual void step() = 0;
+            /**
+             * @brief Advances the board up to `generations` generations at once.
+             *
+             * Engines that can jump ahead override this; the default steps once.
+             * @return The number of generations actually advanced, at least one.
+             */
+            virtual long advance(long generations) {
+                (void)generations;
+                step();
+                return 1;
+            }
+            /// Number of live cells on the board.
+            virtual long population() const = 0;
+            /**
+             * @brief Zobrist fingerprint of the cells on the board (see zobrist_key()).
+             *
+             * Boards with the same cells have the same fingerprint on every engine.
+             * The default scans the board; engines that keep the fingerprint up to
+             * date as cells change return it in constant time.
+             */
+            virtual Hash128 state_hash() const;
+            /**
+             * @brief Fingerprint of the live cells relative to their bounding box.
+             *
+             * Equal up to a translation means equal fingerprints. The default packs
+             * the board through alive() first.
+             */
+            virtual ShapeHash shape_hash() const;
+            /**
+             * @brief Fingerprint of the live cells whatever their position, rotation or reflection.
+             *
+             * The 8 orientations of a pattern, anywhere on the board, have the same
+             * fingerprint, so census results can be indexed by it.
+             */
+            Hash128 canonical_hash() const;
+            /**
+             * @brief Copies the board into `words`, one row after the other.
+             *
+             * Each row takes words_per_row(cols()) words, bit `j` of word `k`
+             * being column 64k + j. The default reads the board through alive().
+             */
+            virtual void pack(std::vector<std::uint64_t>& words) const;
+            /// Replaces the board with `words`, laid out like pack(). The default uses set().
+            virtual void unpack(const std::vector<std::uint64_t>& words);
+            /// Independent copy of the engine and its board, stepped on the calling thread.
+            virtual std::unique_ptr<Engine> clone() const = 0;
+    };
+
+    std::unique_ptr<Engine> make_engine(const std::string& name, int rows, int cols, const Rule& rule,
+                                        const EngineOptions& options = EngineOptions());
+}
+
+#endif // ENGINE_H
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <utility>
+
+#include "frame_writer.h"
+
+namespace life {
+
+    FrameWriter::FrameWriter(std::size_t cols, std::size_t rows, short blockSize, Canvas::format_e format,
+                             const Color& alive, const Color& bkg, int threads, std::size_t capacity)
+        : m_cols(cols), m_rows(rows), m_blockSize(blockSize), m_format(format), m_alive(alive), m_bkg(bkg) {
+        if(threads <= 0){
+            threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        m_capacity = (capacity > 0) ? capacity : 2 * static_cast<std::size_t>(threads);
+        for(int worker = 0; worker < threads; worker++){
+            m_workers.emplace_back(&FrameWriter::worker_loop, this);
+        }
+    }
+
+    FrameWriter::~FrameWriter() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for(std::thread& worker : m_workers){
+            worker.join();
+        }
+    }
+
+/**
+ * @brief Draws and writes the frames in the queue, until stopped with none left.
+ *
+ * A frame is encoded to a temporary file, then renamed to its own name, so a
+ * frame file is never seen half written.
+ */
+    void FrameWriter::worker_loop() {
+        Canvas canvas(m_cols, m_rows, m_blockSize, m_format);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(true){
+            m_wake.wait(lock, [this]{return !m_queue.empty() || m_stop;});
+            if(m_queue.empty()){
+                return;
+            }
+            Frame frame = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busyWorkers++;
+            lock.unlock();
+            m_taken.notify_all();
+
+            canvas.draw_board(frame.cells, m_alive, m_bkg);
+            std::string temporary = frame.path + ".tmp";
+            canvas.save_png(temporary);
+            if(std::rename(temporary.c_str(), frame.path.c_str()) != 0){
+                std::cerr << ">>> Could not write the image " << frame.path << "!" << std::endl;
+            }
+
+            lock.lock();
+            m_busyWorkers--;
+            m_taken.notify_all();
+        }
+    }
+
+    void FrameWriter::submit(Frame frame) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taken.wait(lock, [this]{return m_queue.size() < m_capacity;});
+            m_queue.push_back(std::move(frame));
+        }
+        m_wake.notify_one();
+    }
+
+    void FrameWriter::flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_taken.wait(lock, [this]{return m_queue.empty() && m_busyWorkers == 0;});
+    }
+
+}
@@ -0,0 +1,74 @@
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../lib/canvas.h"
+#include "../lib/common.h"
+
+namespace life {
+    /// A generation to be saved as an image.
+    struct Frame {
+        std::vector<std::uint64_t> cells;   //!< Board packed like Engine::pack().
+        std::string path;                   //!< PNG file to write.
+    };
+
+    //! Draws frames and encodes them as PNG files on threads of their own.
+    /*!
+     * The simulation hands a copy of each board over and goes on stepping. Every
+     * worker keeps a canvas of its own, which only redraws the cells that changed
+     * since the last frame that worker drew. When `capacity` frames are already
+     * waiting, submit() waits for a worker to take one, so the simulation never
+     * gets more than that far ahead of the images.
+     */
+    class FrameWriter {
+        private:
+            std::size_t m_cols;
+            std::size_t m_rows;
+            short m_blockSize;
+            Canvas::format_e m_format;
+            Color m_alive;
+            Color m_bkg;
+            std::size_t m_capacity;
+            std::vector<std::thread> m_workers;
+            std::mutex m_mutex;
+            std::condition_variable m_wake;     //!< A frame is waiting, or the writer stops.
+            std::condition_variable m_taken;    //!< A frame left the queue, or was written.
+            std::deque<Frame> m_queue;
+            int m_busyWorkers = 0;
+            bool m_stop = false;
+
+            void worker_loop();
+
+        public:
+            /**
+             * @param cols Columns of the boards.
+             * @param rows Rows of the boards.
+             * @param blockSize Pixels per cell side.
+             * @param format How the canvases store their pixels.
+             * @param alive Color of live cells.
+             * @param bkg Color of dead cells.
+             * @param threads Encoder threads; zero for one per core.
+             * @param capacity Frames that may wait for a worker; zero for two per thread.
+             */
+            FrameWriter(std::size_t cols, std::size_t rows, short blockSize, Canvas::format_e format,
+                        const Color& alive, const Color& bkg, int threads, std::size_t capacity);
+            ~FrameWriter();
+            FrameWriter(const FrameWriter&) = delete;
+            FrameWriter& operator=(const FrameWriter&) = delete;
+
+            /// Queues a frame to be written, waiting while the queue is full.
+            void submit(Frame frame);
+            /// Waits until every frame submitted is written.
+            void flush();
+    };
+}
+
+#endif // FRAME_WRITER_H
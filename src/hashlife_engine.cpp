@@ -0,0 +1,647 @@
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+
+#include "hashlife_engine.h"
+
+namespace life {
+
+    std::size_t HashLifeEngine::ChildrenHash::operator()(const std::array<Node*, 4>& children) const {
+        std::size_t hash = 0;
+        for(Node* child : children){
+            hash = (hash ^ reinterpret_cast<std::uintptr_t>(child)) * 0x9E3779B97F4A7C15ull;
+        }
+        return hash ^ (hash >> 29);
+    }
+
+/**
+ * @brief Creates an empty board.
+ *
+ * @param rows Number of rows of the board.
+ * @param cols Number of columns of the board.
+ * @param rule Birth and survival conditions. Births with zero neighbors (B0) are
+ *             not supported, since they would fill the empty space around the board.
+ */
+    HashLifeEngine::HashLifeEngine(int rows, int cols, const Rule& rule)
+        : m_rows(rows), m_cols(cols), m_rule(rule) {
+        if(rule.born & 1u){
+            std::cerr << ">>> The hashlife engine does not support births with zero neighbors (B0)!" << std::endl;
+            exit(1);
+        }
+        m_live.population = 1;
+        m_level = 2;
+        while((1L << m_level) < std::max(rows, cols)){
+            m_level++;
+        }
+        m_root = empty(m_level);
+    }
+
+/**
+ * @brief Returns the unique node with the given children, creating it if needed.
+ */
+    HashLifeEngine::Node* HashLifeEngine::join(Node* nw, Node* ne, Node* sw, Node* se) {
+        std::array<Node*, 4> children{nw, ne, sw, se};
+        auto found = m_table.find(children);
+        if(found != m_table.end()){
+            return found->second;
+        }
+        m_nodes.emplace_back();
+        Node* node = &m_nodes.back();
+        node->nw = nw;
+        node->ne = ne;
+        node->sw = sw;
+        node->se = se;
+        node->level = nw->level + 1;
+        node->population = nw->population + ne->population + sw->population + se->population;
+        m_table.emplace(children, node);
+        return node;
+    }
+
+/**
+ * @brief Returns the empty node of a level.
+ */
+    HashLifeEngine::Node* HashLifeEngine::empty(int level) {
+        if(m_empty.empty()){
+            m_empty.push_back(&m_dead);
+        }
+        while(static_cast<int>(m_empty.size()) <= level){
+            Node* below = m_empty.back();
+            m_empty.push_back(join(below, below, below, below));
+        }
+        return m_empty[level];
+    }
+
+/**
+ * @brief Returns the central square of a node, one level down.
+ */
+    HashLifeEngine::Node* HashLifeEngine::center(Node* node) {
+        return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+    }
+
+/**
+ * @brief Returns a node one level up, with the given node in its center and dead cells around.
+ */
+    HashLifeEngine::Node* HashLifeEngine::embed(Node* node) {
+        Node* border = empty(node->level - 1);
+        return join(join(border, border, border, node->nw), join(border, border, node->ne, border),
+                    join(border, node->sw, border, border), join(node->se, border, border, border));
+    }
+
+/**
+ * @brief Computes the central 2x2 cells of a 4x4 node after one generation.
+ */
+    HashLifeEngine::Node* HashLifeEngine::base_successor(Node* node) {
+        int cells[4][4];
+        Node* quadrants[2][2] = {{node->nw, node->ne}, {node->sw, node->se}};
+        for(int row = 0; row < 4; row++){
+            for(int col = 0; col < 4; col++){
+                Node* quadrant = quadrants[row / 2][col / 2];
+                Node* pairs[2][2] = {{quadrant->nw, quadrant->ne}, {quadrant->sw, quadrant->se}};
+                cells[row][col] = static_cast<int>(pairs[row % 2][col % 2]->population);
+            }
+        }
+
+        Node* next[2][2];
+        for(int row = 1; row <= 2; row++){
+            for(int col = 1; col <= 2; col++){
+                int count = 0;
+                for(int dr = -1; dr <= 1; dr++){
+                    for(int dc = -1; dc <= 1; dc++){
+                        count += (dr != 0 || dc != 0) ? cells[row + dr][col + dc] : 0;
+                    }
+                }
+                std::uint16_t conditions = cells[row][col] ? m_rule.survive : m_rule.born;
+                next[row - 1][col - 1] = ((conditions >> count) & 1u) ? &m_live : &m_dead;
+            }
+        }
+        return join(next[0][0], next[0][1], next[1][0], next[1][1]);
+    }
+
+/**
+ * @brief Computes the central square of a node after 2^step generations.
+ *
+ * The step is capped at level - 2, the most a node can see of its own future.
+ * The result is cached in the node.
+ *
+ * @param node A node of level 2 or more.
+ * @param step Base-2 logarithm of the number of generations.
+ * @return The central square, one level below the node.
+ */
+    HashLifeEngine::Node* HashLifeEngine::successor(Node* node, int step) {
+        if(node->population == 0){
+            return empty(node->level - 1);
+        }
+        step = std::min(step, node->level - 2);
+        if(node->result != nullptr && node->resultStep == step){
+            return node->result;
+        }
+
+        Node* result;
+        if(node->level == 2){
+            result = base_successor(node);
+        }else{
+            Node* a = node->nw;
+            Node* b = node->ne;
+            Node* c = node->sw;
+            Node* d = node->se;
+            // Nine overlapping squares of level - 1, advanced by 2^step (or half of it).
+            Node* c1 = successor(a, step);
+            Node* c2 = successor(join(a->ne, b->nw, a->se, b->sw), step);
+            Node* c3 = successor(b, step);
+            Node* c4 = successor(join(a->sw, a->se, c->nw, c->ne), step);
+            Node* c5 = successor(join(a->se, b->sw, c->ne, d->nw), step);
+            Node* c6 = successor(join(b->sw, b->se, d->nw, d->ne), step);
+            Node* c7 = successor(c, step);
+            Node* c8 = successor(join(c->ne, d->nw, c->se, d->sw), step);
+            Node* c9 = successor(d, step);
+            if(step < node->level - 2){
+                // Already advanced by the whole step: just assemble the center.
+                result = join(join(c1->se, c2->sw, c4->ne, c5->nw), join(c2->se, c3->sw, c5->ne, c6->nw),
+                              join(c4->se, c5->sw, c7->ne, c8->nw), join(c5->se, c6->sw, c8->ne, c9->nw));
+            }else{
+                // Advanced by half of the step: advance the four inner squares by the other half.
+                result = join(successor(join(c1, c2, c4, c5), step), successor(join(c2, c3, c5, c6), step),
+                              successor(join(c4, c5, c7, c8), step), successor(join(c5, c6, c8, c9), step));
+            }
+        }
+        node->result = result;
+        node->resultStep = step;
+        return result;
+    }
+
+/**
+ * @brief Returns a copy of the node with one cell changed.
+ *
+ * @param row,col Cell coordinates, relative to the node's top left corner.
+ */
+    HashLifeEngine::Node* HashLifeEngine::set_cell(Node* node, int level, long row, long col, bool alive) {
+        if(level == 0){
+            return alive ? &m_live : &m_dead;
+        }
+        long half = 1L << (level - 1);
+        if(row < half){
+            if(col < half){
+                return join(set_cell(node->nw, level - 1, row, col, alive), node->ne, node->sw, node->se);
+            }
+            return join(node->nw, set_cell(node->ne, level - 1, row, col - half, alive), node->sw, node->se);
+        }
+        if(col < half){
+            return join(node->nw, node->ne, set_cell(node->sw, level - 1, row - half, col, alive), node->se);
+        }
+        return join(node->nw, node->ne, node->sw, set_cell(node->se, level - 1, row - half, col - half, alive));
+    }
+
+/**
+ * @brief Clears every cell of the node that lies outside the board.
+ *
+ * @param row,col Board coordinates of the node's top left corner.
+ */
+    HashLifeEngine::Node* HashLifeEngine::clip(Node* node, long row, long col) {
+        long size = 1L << node->level;
+        if(node->population == 0 || (row + size <= m_rows && col + size <= m_cols)){
+            return node;
+        }
+        if(row >= m_rows || col >= m_cols){
+            return empty(node->level);
+        }
+        long half = size / 2;
+        return join(clip(node->nw, row, col), clip(node->ne, row, col + half),
+                    clip(node->sw, row + half, col), clip(node->se, row + half, col + half));
+    }
+
+/**
+ * @brief Finds how far the live cells of a node reach towards one of its sides.
+ *
+ * Results are memoized by node, so the cost is linear in the number of distinct nodes.
+ *
+ * @param side 0 for the top, 1 for the left, 2 for the bottom and 3 for the right side.
+ * @return The distance from that side to the nearest live cell; the node must not be empty.
+ */
+    long HashLifeEngine::edge_offset(Node* node, int side, std::unordered_map<Node*, long>& memo) {
+        if(node->level == 0){
+            return 0;
+        }
+        auto found = memo.find(node);
+        if(found != memo.end()){
+            return found->second;
+        }
+        // The two children touching the side, then the two children away from it.
+        Node* nearChildren[4][2] = {{node->nw, node->ne}, {node->nw, node->sw}, {node->sw, node->se}, {node->ne, node->se}};
+        Node* farChildren[4][2] = {{node->sw, node->se}, {node->ne, node->se}, {node->nw, node->ne}, {node->nw, node->sw}};
+        long half = 1L << (node->level - 1);
+        long offset = 2 * half;
+        for(Node* child : nearChildren[side]){
+            if(child->population > 0){
+                offset = std::min(offset, edge_offset(child, side, memo));
+            }
+        }
+        if(offset == 2 * half){
+            for(Node* child : farChildren[side]){
+                if(child->population > 0){
+                    offset = std::min(offset, half + edge_offset(child, side, memo));
+                }
+            }
+        }
+        memo.emplace(node, offset);
+        return offset;
+    }
+
+/**
+ * @brief Copies a node into the (fresh) node table.
+ *
+ * The node may belong to another engine; cells are mapped to this engine's own.
+ */
+    HashLifeEngine::Node* HashLifeEngine::rebuild(Node* node, std::unordered_map<Node*, Node*>& copies) {
+        if(node->level == 0){
+            return node->population > 0 ? &m_live : &m_dead;
+        }
+        auto found = copies.find(node);
+        if(found != copies.end()){
+            return found->second;
+        }
+        Node* copy = join(rebuild(node->nw, copies), rebuild(node->ne, copies),
+                          rebuild(node->sw, copies), rebuild(node->se, copies));
+        copies.emplace(node, copy);
+        return copy;
+    }
+
+/**
+ * @brief Drops every node not reachable from the root, along with all cached results.
+ */
+    void HashLifeEngine::collect() {
+        std::deque<Node> oldNodes;
+        std::swap(oldNodes, m_nodes);
+        m_table.clear();
+        m_empty.clear();
+        std::unordered_map<Node*, Node*> copies;
+        m_root = rebuild(m_root, copies);
+        if(m_nodes.size() > m_collectThreshold / 2){
+            m_collectThreshold *= 2;
+        }
+    }
+
+/**
+ * @brief Copies the board into a new engine, which only holds the nodes of the board.
+ */
+    std::unique_ptr<Engine> HashLifeEngine::clone() const {
+        auto copy = std::make_unique<HashLifeEngine>(m_rows, m_cols, m_rule);
+        std::unordered_map<Node*, Node*> copies;
+        copy->m_root = copy->rebuild(m_root, copies);
+        return copy;
+    }
+
+/**
+ * @brief Lists the live cells of a node as (word, bit) pairs, skipping empty nodes.
+ *
+ * @param row,col Position of the node's top-left cell on the board.
+ */
+    void HashLifeEngine::collect_cells(const Node* node, long row, long col,
+                                       std::vector<std::pair<std::uint64_t, std::uint64_t>>& bits) const {
+        if(node->population == 0 || row >= m_rows || col >= m_cols){
+            return;
+        }
+        if(node->level == 0){
+            bits.emplace_back(row * words_per_row(m_cols) + col / 64, std::uint64_t{1} << (col % 64));
+            return;
+        }
+        long half = 1L << (node->level - 1);
+        collect_cells(node->nw, row, col, bits);
+        collect_cells(node->ne, row, col + half, bits);
+        collect_cells(node->sw, row + half, col, bits);
+        collect_cells(node->se, row + half, col + half, bits);
+    }
+
+/**
+ * @brief Fingerprints the board from its live cells only.
+ *
+ * The cells are listed in word order, since the tree visits them by quadrant.
+ */
+    Hash128 HashLifeEngine::state_hash() const {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> bits;
+        collect_cells(m_root, 0, 0, bits);
+        std::sort(bits.begin(), bits.end());
+        Hash128 hash;
+        for(std::size_t first = 0; first < bits.size(); ){
+            std::uint64_t cells = 0;
+            std::size_t last = first;
+            for(; last < bits.size() && bits[last].first == bits[first].first; last++){
+                cells |= bits[last].second;
+            }
+            hash ^= zobrist_key(bits[first].first, cells);
+            first = last;
+        }
+        return hash;
+    }
+
+/**
+ * @brief Packs the live cells only, visiting none of the empty quadrants.
+ */
+    void HashLifeEngine::pack(std::vector<std::uint64_t>& words) const {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> bits;
+        collect_cells(m_root, 0, 0, bits);
+        words.assign(m_rows * words_per_row(m_cols), 0);
+        for(const auto& [word, bit] : bits){
+            words[word] |= bit;
+        }
+    }
+
+    bool HashLifeEngine::alive(int row, int col) const {
+        const Node* node = m_root;
+        long r = row;
+        long c = col;
+        while(node->level > 0){
+            if(node->population == 0){
+                return false;
+            }
+            long half = 1L << (node->level - 1);
+            bool south = r >= half;
+            bool east = c >= half;
+            node = south ? (east ? node->se : node->sw) : (east ? node->ne : node->nw);
+            r -= south ? half : 0;
+            c -= east ? half : 0;
+        }
+        return node->population > 0;
+    }
+
+    void HashLifeEngine::set(int row, int col, bool alive) {
+        m_root = set_cell(m_root, m_level, row, col, alive);
+    }
+
+/**
+ * @brief Builds the node of a square of the packed board, from 8x8 leaves up.
+ *
+ * A leaf takes one byte of each of its eight rows, and its 2x2 squares are
+ * looked up in `squares` instead of joined. A square past the board, a leaf
+ * with no live cells, or four empty quadrants give the empty node at once.
+ *
+ * @param level Level of the square, 3 or more.
+ * @param row,col Position of the square on the board.
+ * @param squares The 16 nodes of 2x2 cells, indexed by nw | ne << 1 | sw << 2 | se << 3.
+ */
+    HashLifeEngine::Node* HashLifeEngine::unpack_node(const std::vector<std::uint64_t>& words, int level,
+                                                      long row, long col, Node* const* squares) {
+        if(row >= m_rows || col >= m_cols){
+            return empty(level);
+        }
+        if(level == 3){
+            std::size_t stride = words_per_row(m_cols);
+            std::uint64_t inside = (col + 8 <= m_cols) ? 0xffu : (std::uint64_t{1} << (m_cols - col)) - 1;
+            std::uint64_t bytes[8];
+            std::uint64_t any = 0;
+            for(int r = 0; r < 8; r++){
+                bytes[r] = (row + r < m_rows) ? (words[(row + r) * stride + col / 64] >> (col % 64)) & inside : 0;
+                any |= bytes[r];
+            }
+            if(any == 0){
+                return empty(3);
+            }
+            Node* quarters[4];
+            for(int quarter = 0; quarter < 4; quarter++){
+                int r = 4 * (quarter / 2);
+                int c = 4 * (quarter % 2);
+                Node* twos[4];
+                for(int two = 0; two < 4; two++){
+                    int tr = r + 2 * (two / 2);
+                    int tc = c + 2 * (two % 2);
+                    twos[two] = squares[((bytes[tr] >> tc) & 3u) | (((bytes[tr + 1] >> tc) & 3u) << 2)];
+                }
+                quarters[quarter] = join(twos[0], twos[1], twos[2], twos[3]);
+            }
+            return join(quarters[0], quarters[1], quarters[2], quarters[3]);
+        }
+        long half = 1L << (level - 1);
+        Node* nw = unpack_node(words, level - 1, row, col, squares);
+        Node* ne = unpack_node(words, level - 1, row, col + half, squares);
+        Node* sw = unpack_node(words, level - 1, row + half, col, squares);
+        Node* se = unpack_node(words, level - 1, row + half, col + half, squares);
+        if(nw->population + ne->population + sw->population + se->population == 0){
+            return empty(level);
+        }
+        return join(nw, ne, sw, se);
+    }
+
+/**
+ * @brief Replaces the board with packed words, building the quadtree bottom-up instead of cell by cell.
+ */
+    void HashLifeEngine::unpack(const std::vector<std::uint64_t>& words) {
+        Node* squares[16];
+        for(int index = 0; index < 16; index++){
+            Node* cells[4];
+            for(int cell = 0; cell < 4; cell++){
+                cells[cell] = ((index >> cell) & 1) ? &m_live : &m_dead;
+            }
+            squares[index] = join(cells[0], cells[1], cells[2], cells[3]);
+        }
+        Node* root = unpack_node(words, std::max(m_level, 3), 0, 0, squares);
+        // A board of 4x4 cells or less is in the top-left quadrant of its leaf.
+        m_root = (root->level > m_level) ? root->nw : root;
+    }
+
+/**
+ * @brief Advances the board by the largest power of two generations that is safe.
+ *
+ * A jump of 2^j generations lets the pattern grow by 2^j - 1 cells before the
+ * last generation, which is clipped anyway. The jump is only taken if that
+ * growth cannot reach the dead border; a single generation is always safe.
+ *
+ * @param generations Most generations to advance.
+ * @return The number of generations advanced.
+ */
+    long HashLifeEngine::advance(long generations) {
+        if(m_nodes.size() > m_collectThreshold){
+            collect();
+        }
+
+        long box[4] = {0, 0, 0, 0};   // Distance from the live cells to the top, left, bottom and right.
+        if(m_root->population > 0){
+            std::unordered_map<Node*, long> memo;
+            for(int side = 0; side < 4; side++){
+                memo.clear();
+                box[side] = edge_offset(m_root, side, memo);
+            }
+            long size = 1L << m_level;
+            box[2] = m_rows - 1 - (size - 1 - box[2]);
+            box[3] = m_cols - 1 - (size - 1 - box[3]);
+        }
+
+        int step = 0;
+        while(step < 60 && (2L << step) <= generations){
+            long reach = (2L << step) - 1;
+            bool fits = m_root->population == 0
+                     || (box[0] >= reach && box[1] >= reach && box[2] >= reach && box[3] >= reach);
+            if(!fits){
+                break;
+            }
+            step++;
+        }
+
+        Node* big = embed(m_root);
+        while(big->level - 2 < step){
+            big = embed(big);
+        }
+        Node* next = successor(big, step);
+        while(next->level > m_level){
+            next = center(next);
+        }
+        m_root = clip(next, 0, 0);
+        return 1L << step;
+    }
+
+/**
+ * @brief Builds the node of an 8x8 Macrocell leaf covering a square of 2^level cells.
+ *
+ * @param row,col Position of the square in the leaf.
+ */
+    HashLifeEngine::Node* HashLifeEngine::leaf(std::uint64_t cells, int level, int row, int col) {
+        if(level == 0){
+            return ((cells >> (8 * row + col)) & 1u) ? &m_live : &m_dead;
+        }
+        int half = 1 << (level - 1);
+        return join(leaf(cells, level - 1, row, col), leaf(cells, level - 1, row, col + half),
+                    leaf(cells, level - 1, row + half, col), leaf(cells, level - 1, row + half, col + half));
+    }
+
+/**
+ * @brief Draws the cells of a node of level 3 or less into an 8x8 Macrocell leaf.
+ *
+ * @param row,col Position of the node in the leaf.
+ */
+    void HashLifeEngine::leaf_cells(const Node* node, int row, int col, std::uint64_t& cells) const {
+        if(node->population == 0){
+            return;
+        }
+        if(node->level == 0){
+            cells |= std::uint64_t{1} << (8 * row + col);
+            return;
+        }
+        int half = 1 << (node->level - 1);
+        leaf_cells(node->nw, row, col, cells);
+        leaf_cells(node->ne, row, col + half, cells);
+        leaf_cells(node->sw, row + half, col, cells);
+        leaf_cells(node->se, row + half, col + half, cells);
+    }
+
+/**
+ * @brief Adds a node and its children to a Macrocell quadtree, each distinct node once.
+ *
+ * @return The number of the node in the quadtree, or 0 if it is empty.
+ */
+    std::size_t HashLifeEngine::export_node(const Node* node, Macrocell& tree,
+                                            std::unordered_map<const Node*, std::size_t>& numbers) const {
+        if(node->population == 0){
+            return 0;
+        }
+        auto found = numbers.find(node);
+        if(found != numbers.end()){
+            return found->second;
+        }
+        Macrocell::Node exported;
+        exported.level = node->level;
+        if(node->level == 3){
+            leaf_cells(node, 0, 0, exported.cells);
+        }else{
+            const Node* children[4] = {node->nw, node->ne, node->sw, node->se};
+            for(int index = 0; index < 4; index++){
+                exported.children[index] = export_node(children[index], tree, numbers);
+            }
+        }
+        tree.nodes.push_back(exported);
+        numbers.emplace(node, tree.nodes.size());
+        return tree.nodes.size();
+    }
+
+/**
+ * @brief Builds an engine from a Macrocell quadtree, without expanding it.
+ *
+ * Each node of the file becomes one node of the engine, and the root of the
+ * file goes at the top-left corner of the board. When the pattern is closer
+ * than `border` cells to the top or left side, the root moves down and right by
+ * its own size, which keeps the quadtree as it is. The board then ends `border`
+ * cells past the bottom and right of the pattern.
+ *
+ * @param tree Quadtree read from the file.
+ * @param rule Birth and survival conditions.
+ * @param border Fewest dead cells between the pattern and the sides of the board.
+ */
+    std::unique_ptr<HashLifeEngine> HashLifeEngine::from_macrocell(const Macrocell& tree, const Rule& rule, int border) {
+        auto engine = std::make_unique<HashLifeEngine>(1, 1, rule);
+        std::vector<Node*> nodes;
+        nodes.reserve(tree.nodes.size());
+        for(const Macrocell::Node& node : tree.nodes){
+            if(node.level == 3){
+                nodes.push_back(engine->leaf(node.cells, 3, 0, 0));
+            }else{
+                Node* children[4];
+                for(int index = 0; index < 4; index++){
+                    std::size_t child = node.children[index];
+                    children[index] = (child == 0) ? engine->empty(node.level - 1) : nodes[child - 1];
+                }
+                nodes.push_back(engine->join(children[0], children[1], children[2], children[3]));
+            }
+        }
+        Node* root = nodes.empty() ? engine->empty(3) : nodes.back();
+
+        long size = 1L << root->level;
+        long box[4] = {size, size, -1, -1};    // Top, left, bottom and right of the pattern.
+        if(root->population > 0){
+            std::unordered_map<Node*, long> memo;
+            for(int side = 0; side < 4; side++){
+                memo.clear();
+                long offset = engine->edge_offset(root, side, memo);
+                box[side] = (side < 2) ? offset : size - 1 - offset;
+            }
+        }else{
+            box[0] = box[1] = box[2] = box[3] = 0;
+        }
+        while(box[0] < border || box[1] < border){
+            Node* around = engine->empty(root->level);
+            root = engine->join(around, around, around, root);
+            for(long& side : box){
+                side += size;
+            }
+            size *= 2;
+        }
+
+        long rows = box[2] + 1 + border;
+        long cols = box[3] + 1 + border;
+        if(rows > (1L << 30) || cols > (1L << 30)){
+            std::cerr << ">>> The pattern is too large for the board (" << rows << " x " << cols << ")!" << std::endl;
+            exit(1);
+        }
+        engine->m_rows = static_cast<int>(rows);
+        engine->m_cols = static_cast<int>(cols);
+        engine->m_level = 2;
+        while((1L << engine->m_level) < std::max(rows, cols)){
+            engine->m_level++;
+        }
+        // The live cells are within the board, so past its size only the top-left quadrant has any.
+        while(root->level > engine->m_level){
+            root = root->nw;
+        }
+        while(root->level < engine->m_level){
+            Node* around = engine->empty(root->level);
+            root = engine->join(root, around, around, around);
+        }
+        engine->m_root = root;
+        return engine;
+    }
+
+/**
+ * @brief Exports the board as a Macrocell quadtree, each distinct node once.
+ *
+ * The root is at least a level 3 node, the size of a Macrocell leaf.
+ */
+    Macrocell HashLifeEngine::to_macrocell() const {
+        Macrocell tree;
+        std::unordered_map<const Node*, std::size_t> numbers;
+        if(m_level < 3){
+            Macrocell::Node root;
+            leaf_cells(m_root, 0, 0, root.cells);
+            tree.nodes.push_back(root);
+        }else if(export_node(m_root, tree, numbers) == 0){
+            tree.nodes.push_back(Macrocell::Node());
+        }
+        return tree;
+    }
+
+}
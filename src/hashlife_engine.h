@@ -0,0 +1,99 @@
+#ifndef HASHLIFE_ENGINE_H
+#define HASHLIFE_ENGINE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "engine.h"
+#include "macrocell.h"
+
+namespace life {
+    //! Engine that stores the board as a memoized quadtree (HashLife).
+    /*!
+     * Every square of 2^k x 2^k cells is a node with four children of level k - 1.
+     * Nodes are hash-consed, so equal squares are the same node, and each node
+     * caches the center of its future, which lets regular patterns advance 2^j
+     * generations at once.
+     *
+     * The board keeps the dead border of the other engines: before a jump, the
+     * engine checks that the pattern cannot reach the border during the jump, and
+     * uses a shorter jump otherwise. Cells pushed past the border are cleared after
+     * each jump, so the result matches the dense engines generation by generation.
+     */
+    class HashLifeEngine : public Engine {
+        public:
+            /// A square of 2^level x 2^level cells.
+            struct Node {
+                Node* nw = nullptr;
+                Node* ne = nullptr;
+                Node* sw = nullptr;
+                Node* se = nullptr;
+                Node* result = nullptr;     //!< Cached center after 2^resultStep generations.
+                long population = 0;
+                int level = 0;
+                int resultStep = -1;
+            };
+
+        private:
+            /// Hash of the four children of a node.
+            struct ChildrenHash {
+                std::size_t operator()(const std::array<Node*, 4>& children) const;
+            };
+
+            int m_rows;
+            int m_cols;
+            Rule m_rule;
+            int m_level;                    //!< Level of the root; the root covers the board from (0, 0).
+            Node* m_root;
+            Node m_dead;                    //!< Level 0 dead cell.
+            Node m_live;                    //!< Level 0 live cell.
+            std::deque<Node> m_nodes;
+            std::unordered_map<std::array<Node*, 4>, Node*, ChildrenHash> m_table;
+            std::vector<Node*> m_empty;     //!< Empty node of each level.
+            std::size_t m_collectThreshold = 1u << 22;
+
+            Node* join(Node* nw, Node* ne, Node* sw, Node* se);
+            Node* empty(int level);
+            Node* center(Node* node);
+            Node* embed(Node* node);
+            Node* base_successor(Node* node);
+            Node* successor(Node* node, int step);
+            Node* set_cell(Node* node, int level, long row, long col, bool alive);
+            Node* clip(Node* node, long row, long col);
+            long edge_offset(Node* node, int side, std::unordered_map<Node*, long>& memo);
+            Node* rebuild(Node* node, std::unordered_map<Node*, Node*>& copies);
+            Node* leaf(std::uint64_t cells, int level, int row, int col);
+            Node* unpack_node(const std::vector<std::uint64_t>& words, int level, long row, long col, Node* const* squares);
+            void leaf_cells(const Node* node, int row, int col, std::uint64_t& cells) const;
+            std::size_t export_node(const Node* node, Macrocell& tree, std::unordered_map<const Node*, std::size_t>& numbers) const;
+            void collect_cells(const Node* node, long row, long col, std::vector<std::pair<std::uint64_t, std::uint64_t>>& bits) const;
+            void collect();
+
+        public:
+            HashLifeEngine(int rows, int cols, const Rule& rule);
+            HashLifeEngine(const HashLifeEngine&) = delete;
+            HashLifeEngine& operator=(const HashLifeEngine&) = delete;
+
+            int rows() const override {return m_rows;}
+            int cols() const override {return m_cols;}
+            bool alive(int row, int col) const override;
+            void set(int row, int col, bool alive) override;
+            void step() override {advance(1);}
+            long advance(long generations) override;
+            long population() const override {return m_root->population;}
+            Hash128 state_hash() const override;
+            void pack(std::vector<std::uint64_t>& words) const override;
+            void unpack(const std::vector<std::uint64_t>& words) override;
+            std::unique_ptr<Engine> clone() const override;
+
+            static std::unique_ptr<HashLifeEngine> from_macrocell(const Macrocell& tree, const Rule& rule, int border);
+            Macrocell to_macrocell() const;
+    };
+}
+
+#endif // HASHLIFE_ENGINE_H
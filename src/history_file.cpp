@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "history_file.h"
+
+namespace life {
+
+    HistoryFile::Snapshot::Snapshot(int fd, std::size_t size, std::size_t offset) : m_fd(fd), m_size(size) {
+        // Mappings start at a page boundary, so the entries may start inside the first page.
+        std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::size_t start = offset - offset % page;
+        m_mappedBytes = offset - start + size * sizeof(Entry);
+        m_mapped = mmap(nullptr, m_mappedBytes, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(start));
+        if(m_mapped == MAP_FAILED){
+            std::cerr << ">>> Could not map the history file!" << std::endl;
+            exit(1);
+        }
+        m_entries = reinterpret_cast<const Entry*>(static_cast<const char*>(m_mapped) + (offset - start));
+    }
+
+    HistoryFile::Snapshot::~Snapshot() {
+        munmap(m_mapped, m_mappedBytes);
+        close(m_fd);
+    }
+
+/**
+ * @brief Looks a fingerprint up in each run: in its fence index first, then in one block of it.
+ *
+ * @return The generation recorded for the fingerprint, or -1.
+ */
+    long HistoryFile::find(const Hash128& hash) const {
+        for(auto run = m_runs.rbegin(); run != m_runs.rend(); ++run){
+            // The block starts at the last fence not after the fingerprint.
+            auto fence = std::upper_bound(run->fences.begin(), run->fences.end(), hash, less);
+            if(fence == run->fences.begin()){
+                continue;
+            }
+            const Entry* entries = run->snapshot->entries();
+            std::size_t first = (fence - run->fences.begin() - 1) * fence_gap;
+            std::size_t last = std::min(first + fence_gap, run->snapshot->size());
+            const Entry* found = std::lower_bound(entries + first, entries + last, hash,
+                                                  [](const Entry& entry, const Hash128& key){return less(entry.hash, key);});
+            if(found != entries + last && found->hash == hash){
+                return static_cast<long>(found->generation);
+            }
+        }
+        return -1;
+    }
+
+/**
+ * @brief Adds a run after the others, and builds its fence index.
+ */
+    void HistoryFile::push_run(std::shared_ptr<const Snapshot> snapshot) {
+        Run run;
+        run.snapshot = std::move(snapshot);
+        for(std::size_t index = 0; index < run.snapshot->size(); index += fence_gap){
+            run.fences.push_back(run.snapshot->entries()[index].hash);
+        }
+        m_size += run.snapshot->size();
+        m_runs.push_back(std::move(run));
+    }
+
+/**
+ * @brief Writes the entries, merged with the newest runs no larger than what is merged so far, as a new run.
+ *
+ * The runs merged go away once no snapshot of them is held any more.
+ *
+ * @param entries New entries, sorted by fingerprint.
+ * @param count Number of new entries.
+ */
+    void HistoryFile::add(const Entry* entries, std::size_t count) {
+        if(count == 0){
+            return;
+        }
+        struct Source {
+            const Entry* next;
+            const Entry* end;
+        };
+        std::vector<Source> sources = {{entries, entries + count}};
+        Runs merged;    // Keeps the runs merged mapped until the new one is written.
+        std::size_t total = count;
+        while(!m_runs.empty() && m_runs.back().snapshot->size() <= total){
+            merged.push_back(std::move(m_runs.back().snapshot));
+            m_runs.pop_back();
+            sources.push_back({merged.back()->entries(), merged.back()->entries() + merged.back()->size()});
+            total += merged.back()->size();
+            m_size -= merged.back()->size();
+        }
+
+        std::string directory = m_directory.empty() ? std::filesystem::temp_directory_path().string() : m_directory;
+        std::string path = directory + "/glife_history_XXXXXX";
+        int fd = mkstemp(path.data());
+        if(fd < 0){
+            std::cerr << ">>> Could not create the history file in " << directory << "!" << std::endl;
+            exit(1);
+        }
+        unlink(path.c_str());
+
+        std::vector<Entry> buffer;
+        buffer.reserve(4096);
+        auto flush = [&](){
+            const char* data = reinterpret_cast<const char*>(buffer.data());
+            std::size_t left = buffer.size() * sizeof(Entry);
+            while(left > 0){
+                ssize_t written = write(fd, data, left);
+                if(written <= 0){
+                    std::cerr << ">>> Could not write the history file in " << directory << "!" << std::endl;
+                    exit(1);
+                }
+                data += written;
+                left -= static_cast<std::size_t>(written);
+            }
+            buffer.clear();
+        };
+        while(true){
+            Source* smallest = nullptr;
+            for(Source& source : sources){
+                if(source.next != source.end && (!smallest || less(source.next->hash, smallest->next->hash))){
+                    smallest = &source;
+                }
+            }
+            if(!smallest){
+                break;
+            }
+            buffer.push_back(*smallest->next++);
+            if(buffer.size() == buffer.capacity()){
+                flush();
+            }
+        }
+        flush();
+
+        push_run(std::make_shared<const Snapshot>(fd, total));
+    }
+
+    void HistoryFile::adopt(const Runs& runs) {
+        for(const std::shared_ptr<const Snapshot>& run : runs){
+            if(run && run->size() > 0){
+                push_run(run);
+            }
+        }
+    }
+
+    HistoryFile::Runs HistoryFile::runs() const {
+        Runs runs;
+        for(const Run& run : m_runs){
+            runs.push_back(run.snapshot);
+        }
+        return runs;
+    }
+
+}
@@ -0,0 +1,107 @@
+#ifndef HISTORY_FILE_H
+#define HISTORY_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "state_hash.h"
+
+namespace life {
+    //! Fingerprints spilled from memory, kept in sorted runs of memory-mapped files.
+    /*!
+     * Each spill writes its entries as a new run, merged with the newest runs
+     * that hold no more entries than it does, like carries in a binary counter.
+     * So run sizes grow geometrically, an entry is rewritten about log2 times
+     * its number of spills, and a few dozen runs at most are kept. Files are
+     * unlinked as soon as they are created, so they disappear with the process.
+     *
+     * A lookup searches each run, newest first: a small index holding every
+     * `fence_gap`-th fingerprint of the run, then one block of it, so it
+     * touches a few pages per run only.
+     */
+    class HistoryFile {
+        public:
+            /// A fingerprint and the generation it was first seen at, as stored on disk.
+            struct Entry {
+                Hash128 hash;
+                std::int64_t generation = -1;
+            };
+
+            //! Sorted entries of one run, mapped from a file.
+            /*!
+             * A merge writes a new file instead of changing this one, so a
+             * snapshot stays valid, and mapped, for as long as someone holds it.
+             */
+            class Snapshot {
+                private:
+                    int m_fd;
+                    void* m_mapped;             //!< Start of the mapping, at a page boundary.
+                    std::size_t m_mappedBytes;
+                    const Entry* m_entries;
+                    std::size_t m_size;
+
+                public:
+                    /**
+                     * @brief Maps `size` entries of an open file, which the snapshot then closes.
+                     *
+                     * @param fd The file.
+                     * @param size Number of entries.
+                     * @param offset Byte of the file where the first entry starts.
+                     */
+                    Snapshot(int fd, std::size_t size, std::size_t offset = 0);
+                    Snapshot(const Snapshot&) = delete;
+                    Snapshot& operator=(const Snapshot&) = delete;
+                    ~Snapshot();
+
+                    const Entry* entries() const {return m_entries;}
+                    std::size_t size() const {return m_size;}
+            };
+
+            /// The runs as they are now, oldest first, which later merges leave untouched.
+            using Runs = std::vector<std::shared_ptr<const Snapshot>>;
+
+            static constexpr std::size_t fence_gap = 512;
+
+        private:
+            struct Run {
+                std::shared_ptr<const Snapshot> snapshot;
+                std::vector<Hash128> fences;    //!< Every `fence_gap`-th fingerprint of the run.
+            };
+
+            std::string m_directory;
+            std::vector<Run> m_runs;    //!< Oldest and largest first.
+            std::size_t m_size = 0;
+
+            void push_run(std::shared_ptr<const Snapshot> snapshot);
+
+        public:
+            /**
+             * @param directory Where the files are created; empty for the system temporary directory.
+             */
+            explicit HistoryFile(std::string directory) : m_directory(std::move(directory)) {}
+            HistoryFile(const HistoryFile&) = delete;
+            HistoryFile& operator=(const HistoryFile&) = delete;
+
+            /// Generation recorded for a fingerprint, or -1 if it is not on disk.
+            long find(const Hash128& hash) const;
+            /// Adds `count` entries, sorted by fingerprint and not on disk already.
+            void add(const Entry* entries, std::size_t count);
+            /// Takes runs from runs() of another history over, as they are.
+            void adopt(const Runs& runs);
+            /// Number of fingerprints on disk.
+            std::size_t size() const {return m_size;}
+            /// The runs as they are now.
+            Runs runs() const;
+
+            /// Order of the fingerprints in the file.
+            static bool less(const Hash128& a, const Hash128& b) {
+                return a.high != b.high ? a.high < b.high : a.low < b.low;
+            }
+    };
+}
+
+#endif // HISTORY_FILE_H
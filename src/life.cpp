@@ -1,20 +1,31 @@
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <fstream> 
 #include <utility>
-#include <set>
 #include <sstream>
 #include <cstdlib> // for system
 #include <thread>   // for sleep_for
 #include <chrono>   // for chrono::seconds
+#include <csignal>
 
 #include "life.h"
+#include "hashlife_engine.h"
 #include "../lib/canvas.h"
 #include "../lib/common.h"
 
 
 namespace life{
 
+    namespace {
+        /// Set by SIGTERM: the simulation loop writes a checkpoint and stops.
+        volatile std::sig_atomic_t stopRequested = 0;
+
+        void request_stop(int) {
+            stopRequested = 1;
+        }
+    }
+
     /*!
 * Checks if a directory exists.
 *
@@ -33,65 +44,179 @@ bool file_exists(const std::string &str) {
  *
  * This function reads the matrix configuration from the specified file,
  * initializes the matrix size, and sets the character representing a live cell.
+ * The file is mapped in memory and converted on every core; see read_dat().
+ * Files ending in ".rle" and ".mc" are read by read_rle_config() and
+ * read_macrocell_config() instead.
  *
  * @param path The path to the configuration file.
  */
     void Life::read_matrix_config(std::string path){
         path = "../" + path;
-        std::ifstream inputFile(path);
 
         if(!file_exists(path)){
         std::cout<< "File doesn't exist, try again" <<std::endl;
         exit(1);
         }
 
-        if (!inputFile.is_open()) { 
-            std::cerr << "Error opening the matrix intiation file! " << path << std::endl;
+        if(path.size() >= 4 && path.compare(path.size() - 4, 4, ".rle") == 0){
+            read_rle_config(path);
+            return;
+        }
+        if(path.size() >= 3 && path.compare(path.size() - 3, 3, ".mc") == 0){
+            read_macrocell_config(path);
             return;
         }
 
-        std::string line;
+        DatPattern pattern = read_dat(path);
+        m_rows = pattern.rows + 2;
+        m_cols = pattern.cols + 2;
 
-        std::getline(inputFile, line);
+        std::cout << ">>> Grid size read from input file: " << m_rows - 2 << " rows by " << m_cols - 2 << " cols." << std::endl;
 
-        size_t spacePos = line.find(' ');
+        m_liveChar = pattern.liveChar;
 
-        m_rows = stoi(line.substr(0, spacePos)) + 2;
-        m_cols = stoi(line.substr(spacePos + 1)) + 2;
+        std::cout << ">>> Character that represents a living cell read from input file: " << m_liveChar << std::endl;
 
-        std::cout << ">>> Grid size read from input file: " << m_rows - 2 << " rows by " << m_cols - 2 << " cols." << std::endl;
+        m_engine = make_engine(m_engineName, m_rows - 2, m_cols - 2, get_rule(), m_engineOptions);
+        m_engine->unpack(pattern.cells);
 
-        std::getline(inputFile, line);
-        m_liveChar = line[0];
+        std::cout << ">>> Finished reading input data file.\n" << std::endl;
+    }
 
-        std::cout << ">>> Character that represents a living cell read from input file: " << m_liveChar << std::endl;
+/**
+ * @brief Reads the initial board from an RLE file.
+ *
+ * The board is the pattern with `pattern_border` dead cells on each side. A rule in
+ * the header of the file replaces the one from the configuration file.
+ *
+ * @param path The path to the RLE file.
+ */
+    void Life::read_rle_config(const std::string& path){
+        RlePattern pattern = read_rle(path, m_patternBorder);
+        if(!pattern.rule.empty()){
+            m_gameRules = pattern.rule;
+            set_conditions(m_gameRules);
+            std::cout << ">>> Rule read from input file: " << m_gameRules << std::endl;
+        }
+        m_rows = pattern.rows + 2;
+        m_cols = pattern.cols + 2;
+        std::cout << ">>> Grid size read from input file: " << m_rows - 2 << " rows by " << m_cols - 2 << " cols." << std::endl;
 
-        // Resize the matrix to the appropriate number of rows and columns
-        m_currentMatrix.resize(m_rows, std::vector<int>(m_cols, 0));
+        m_engine = make_engine(m_engineName, pattern.rows, pattern.cols, get_rule(), m_engineOptions);
+        m_engine->unpack(pattern.cells);
+        std::cout << ">>> Finished reading input data file.\n" << std::endl;
+    }
 
-        std::string rowSubstring;
-        for(int ii = 1; ii < m_rows-1; ii++){
-            std::getline(inputFile, line);
-            int lineSize = static_cast<int>(line.size());
-            if(lineSize < m_cols){
-                rowSubstring = line;
-                rowSubstring.resize(m_cols, '.');
-            }else{
-                rowSubstring = line.substr(0, m_cols);
-            }
-            for (int jj = 1; jj < m_cols-1; jj++) {
-                if (rowSubstring[jj-1] == m_liveChar) {
-                    m_currentMatrix[ii][jj] = 1;
-                } else {
-                    m_currentMatrix[ii][jj] = 0;
-                }
-            }
+/**
+ * @brief Reads the initial board from a Macrocell file.
+ *
+ * The quadtree of the file is loaded node by node into a hashlife engine, so the
+ * pattern is never expanded when the hashlife engine is selected; other engines
+ * get a dense copy of it. A rule in the file replaces the one from the
+ * configuration file.
+ *
+ * @param path The path to the Macrocell file.
+ */
+    void Life::read_macrocell_config(const std::string& path){
+        Macrocell tree = read_macrocell(path);
+        if(!tree.rule.empty()){
+            m_gameRules = tree.rule;
+            set_conditions(m_gameRules);
+            std::cout << ">>> Rule read from input file: " << m_gameRules << std::endl;
         }
+        std::unique_ptr<HashLifeEngine> quadtree = HashLifeEngine::from_macrocell(tree, get_rule(), m_patternBorder);
+        m_rows = quadtree->rows() + 2;
+        m_cols = quadtree->cols() + 2;
+        std::cout << ">>> Grid size read from input file: " << m_rows - 2 << " rows by " << m_cols - 2 << " cols." << std::endl;
 
-        inputFile.close();
+        if(m_engineName == "hashlife"){
+            m_engine = std::move(quadtree);
+        }else{
+            m_engine = make_engine(m_engineName, quadtree->rows(), quadtree->cols(), get_rule(), m_engineOptions);
+            std::vector<std::uint64_t> cells;
+            quadtree->pack(cells);
+            m_engine->unpack(cells);
+        }
         std::cout << ">>> Finished reading input data file.\n" << std::endl;
     }
 
+/**
+ * @brief Writes the board to `output_mc` as a Macrocell file.
+ *
+ * The hashlife engine exports its own quadtree; the board of other engines is
+ * copied into a hashlife engine first.
+ */
+    void Life::write_macrocell_output() const {
+        const HashLifeEngine* quadtree = dynamic_cast<const HashLifeEngine*>(m_engine.get());
+        std::unique_ptr<HashLifeEngine> copy;
+        if(!quadtree){
+            copy = std::make_unique<HashLifeEngine>(m_engine->rows(), m_engine->cols(), get_rule());
+            std::vector<std::uint64_t> cells;
+            m_engine->pack(cells);
+            copy->unpack(cells);
+            quadtree = copy.get();
+        }
+        Macrocell tree = quadtree->to_macrocell();
+        tree.rule = m_gameRules;
+        write_macrocell(m_mcOutput, tree);
+        std::cout << ">>> Last generation written to " << m_mcOutput << "." << std::endl;
+    }
+
+/**
+ * @brief Goes on with a run from a checkpoint, instead of reading input_cfg.
+ *
+ * The board, the generation and the rule come from the checkpoint, and so does
+ * the cycle detection history when it was made with the same cycle_detection
+ * and translated_cycles.
+ *
+ * @param path The path to the checkpoint.
+ */
+    void Life::read_checkpoint_config(const std::string& path){
+        Checkpoint checkpoint = read_checkpoint(path);
+        std::string born;
+        std::string survive;
+        for(int count = 0; count <= 8; count++){
+            born += ((checkpoint.rule.born >> count) & 1u) ? std::to_string(count) : "";
+            survive += ((checkpoint.rule.survive >> count) & 1u) ? std::to_string(count) : "";
+        }
+        m_gameRules = "B" + born + "/S" + survive;
+        set_conditions(m_gameRules);
+        m_rows = checkpoint.rows + 2;
+        m_cols = checkpoint.cols + 2;
+        m_firstGeneration = static_cast<int>(checkpoint.generation);
+        std::cout << ">>> Resuming from " << path << " at generation " << m_firstGeneration << ", rule " << m_gameRules
+                  << ", " << m_rows - 2 << " rows by " << m_cols - 2 << " cols." << std::endl;
+
+        m_engine = make_engine(m_engineName, checkpoint.rows, checkpoint.cols, get_rule(), m_engineOptions);
+        m_engine->unpack(checkpoint.cells);
+        if(!m_cycles->load(checkpoint.cycles, checkpoint.spilled, *m_engine)){
+            std::cout << ">>> The checkpoint was made with another cycle detection; its history is not used." << std::endl;
+            m_cycles = make_cycle_detector(m_cycleOptions);
+            m_cycles->use_archive(m_archive.get());
+        }
+        std::cout << ">>> Finished reading the checkpoint.\n" << std::endl;
+    }
+
+/**
+ * @brief Hands the state of the run to the checkpoint writer, which writes it in the background.
+ *
+ * Only the board and the fingerprints the cycle detection holds in memory are
+ * copied here; those spilled to disk are shared with the writer, which copies
+ * them from the spill file.
+ *
+ * @param genCount The generation of the board, not yet recorded by the cycle detection.
+ */
+    void Life::save_checkpoint(int genCount){
+        Checkpoint checkpoint;
+        checkpoint.rows = m_engine->rows();
+        checkpoint.cols = m_engine->cols();
+        checkpoint.generation = genCount;
+        checkpoint.rule = get_rule();
+        m_engine->pack(checkpoint.cells);
+        m_cycles->save(checkpoint.cycles);
+        checkpoint.spilled = m_cycles->spilled();
+        m_checkpoints->submit(std::move(checkpoint));
+    }
 
 /**
  * @brief Sets the conditions for cell birth and survival.
@@ -106,7 +231,10 @@ bool file_exists(const std::string &str) {
 
         std::string bornPart = input.substr(1, slashPos - 1);
         std::string survivesPart = input.substr(slashPos + 2);
-        
+
+        // The parsed rule replaces the default B3/S23 instead of adding to it.
+        m_bornConditions.clear();
+        m_surviveConditions.clear();
         for(char c : bornPart){
             m_bornConditions.push_back(c - '0');
         }
@@ -142,174 +270,119 @@ bool file_exists(const std::string &str) {
     }
 
 /**
- * @brief Finds the dead neighbors of a cell.
+ * @brief Converts the engine's birth and survival conditions into rule masks.
  *
- * This function finds the dead neighbors of a cell at the specified row and column.
- *
- * @param row The row index of the cell.
- * @param col The column index of the cell.
- * @return A vector of pairs representing the coordinates of the dead neighbors.
+ * @return The rule used to build the stepping engine.
  */
-    std::vector<std::pair<int, int>> Life::find_dead_neighbors(int row, int col){
-        std::vector<std::pair<int, int>> coords;
-        std::vector<std::pair<int, int>> directions = {
-            {-1, -1}, {-1, 0}, {-1, 1},
-            { 0, -1},         { 0, 1},
-            { 1, -1}, { 1, 0}, { 1, 1}
-        };
-
-        int count = 0;
-        for(const auto& dir : directions){
-            if(m_currentMatrix[row + dir.first][col + dir.second] == 0){
-                coords.emplace_back((row + dir.first), (col + dir.second));
-                count++;
+    Rule Life::get_rule() const {
+        Rule rule{0, 0};
+        for(int condition : m_bornConditions){
+            if(condition >= 0 && condition <= 8){
+                rule.born |= static_cast<std::uint16_t>(1u << condition);
             }
         }
-
-        return coords;
-    }
-
-/**
- * @brief Counts the live neighbors of a cell.
- *
- * This function counts the live neighbors of a cell at the specified row and column.
- *
- * @param row The row index of the cell.
- * @param col The column index of the cell.
- * @return The number of live neighbors.
- */
-    int Life::count_live_neighbors(int row, int col){
-        int count = 0;
-        std::vector<std::pair<int, int>> directions = {
-            {-1, -1}, {-1, 0}, {-1, 1},
-            { 0, -1},         { 0, 1},
-            { 1, -1}, { 1, 0}, { 1, 1}
-        };
-
-        for(const auto& dir : directions){
-            if(m_currentMatrix[row + dir.first][col + dir.second] == 1){
-                count++;
+        for(int condition : m_surviveConditions){
+            if(condition >= 0 && condition <= 8){
+                rule.survive |= static_cast<std::uint16_t>(1u << condition);
             }
         }
-
-        return count;
+        return rule;
     }
 
 /**
- * @brief Sets the borders cells. A cell is considered a border cell when it is a dead neighbor of a live cell.
+ * @brief Hands a copy of the current board over to be saved as a PNG image.
+ *
+ * The image is drawn and encoded by the threads of a FrameWriter while the
+ * simulation goes on; this only waits when image_queue frames are already waiting.
  *
- * This function sets the borders cells by marking the dead neighbors of live cells.
+ * @param genCount The generation of the board, used in the filename of the image.
  */
-    void Life::set_borders(){
-        for(int ii = 1; ii < m_rows -1; ii++){
-            for(int jj = 1; jj < m_cols-1; jj++){
-                if(m_currentMatrix[ii][jj] == 1){
-                    std::vector<std::pair<int, int>> deadNeighbors = find_dead_neighbors(ii, jj);
-                    for(const auto& cell : deadNeighbors){
-                        m_currentMatrix[cell.first][cell.second] = 2;
-                    }
-                }
-            }
+    void Life::draw_frame(int genCount){
+        if(!m_frames){
+            m_frames = std::make_unique<FrameWriter>(m_engine->cols(), m_engine->rows(), m_blockSize,
+                                                     m_palette ? Canvas::PALETTE : Canvas::RGBA,
+                                                     color_pallet[m_aliveColor], color_pallet[m_bkgColor],
+                                                     m_imageThreads, m_imageQueue);
         }
+        Frame frame;
+        m_engine->pack(frame.cells);
+        frame.path = m_imagePath + "/" + extractConfigPrefix() + std::to_string(genCount) + ".png";
+        m_frames->submit(std::move(frame));
     }
 
 /**
- * @brief Generates a new matrix for the next generation.
+ * @brief Counts the number of alive cells in the current matrix.
  *
- * This function generates a new matrix for the next generation based on the current matrix
- * and the birth and survival conditions.
+ * This function counts the number of alive cells in the current generation.
  *
- * @return The new matrix for the next generation.
+ * @return The number of alive cells.
  */
-    std::vector<std::vector<int>> Life::generate_new_matrix(){
-        set_borders();
-        std::vector<std::vector<int>> newMatrix = m_currentMatrix;
-        for(int ii = 1; ii < m_rows-1; ii++){
-            for(int jj = 1; jj < m_cols-1; jj++){
-                if(m_currentMatrix[ii][jj] == 1){
-                    int aliveNeighbors = count_live_neighbors(ii, jj);
-                    bool willSurvive = false;
-                    for(const auto& surviveCondition : m_surviveConditions){
-                        if(aliveNeighbors == surviveCondition){
-                            willSurvive = true;
-                        }
-                    }
-                    if(!willSurvive){
-                        newMatrix[ii][jj] = 0;
-                    }
-                }
-                if(m_currentMatrix[ii][jj] == 2){
-                    int aliveNeighbors = count_live_neighbors(ii, jj);
-                    for(const auto& bornCondition : m_bornConditions){
-                        if(aliveNeighbors == bornCondition){
-                            newMatrix[ii][jj] = 1;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-
-        return newMatrix;
+    int Life::count_alive_cells(){
+        return static_cast<int>(m_engine->population());
     }
 
 /**
- * @brief Counts the number of alive cells in the current matrix.
+ * @brief Checks if the current matrix repeats an earlier generation.
  *
- * This function counts the number of alive cells (cells with value 1) in the current matrix.
+ * Only fingerprints of the generations are kept; see CycleDetector.
  *
- * @return The number of alive cells.
+ * @param genCount The current generation count.
+ * @return True if the current matrix was already generated.
  */
-    int Life::count_alive_cells(){
-        int count = 0;
-        for (const auto& row : m_currentMatrix) {
-            for (int value : row) {
-                if(value == 1){
-                    count++;
-                }
-            }
+    bool Life::matrix_is_repeated(int genCount) {
+        if(!m_cycles->repeated(*m_engine, genCount)){
+            return false;
         }
-
-        return count;
+        std::cout << ">>> Cycle found at generation " << genCount << ": it starts at generation " << m_cycles->start()
+                  << " and has period " << m_cycles->period();
+        if(m_cycles->shift_rows() != 0 || m_cycles->shift_cols() != 0){
+            std::cout << ", moving " << m_cycles->shift_rows() << " rows down and " << m_cycles->shift_cols()
+                      << " columns right each period";
+        }
+        std::cout << "." << std::endl;
+        return true;
     }
 
 /**
- * @brief Generates a string key for the current matrix.
- *
- * This function generates a string key representing the current matrix state,
- * used for detecting repeated patterns.
+ * @brief Goes back to a past generation through the archive and prints its board.
  *
- * @return A string key representing the current matrix state.
+ * @param generation The generation to show.
  */
-    std::string Life::generate_matrix_key(){
-        std::string stringfication;
-        std::stringstream oss;
-        for(int ii = 1; ii < m_rows-1; ii++){
-            for(int jj = 1; jj < m_cols-1; jj++){
-                if(m_currentMatrix[ii][jj] == 2){
-                    oss << "0";
-                }else{
-                    oss << m_currentMatrix[ii][jj];
-                }
-            }
+    void Life::show_archived(int generation) {
+        if(!m_archive){
+            std::cout << ">>> archive_seek needs archive_interval to keep the generations." << std::endl;
+            return;
         }
-
-        stringfication = oss.str();
-        return stringfication;
+        int restored = rewind(generation);
+        if(restored < 0){
+            std::cout << ">>> Generation " << generation << " is not in the archive." << std::endl;
+            return;
+        }
+        std::cout << ">>> Restored from the archive (" << m_archive->bytes() << " bytes):" << std::endl;
+        print_matrix(restored);
     }
 
 /**
- * @brief Checks if the given matrix key is already present.
+ * @brief Puts the board of a past generation back, to go on with the run from it.
  *
- * This function checks if the given matrix key is already present in the set of all matrices.
+ * The archive keeps the run up to that generation only, and cycle detection
+ * starts over, since the generations after it will be simulated again. The
+ * tiles engine gets its window back, but not the cells that left it.
  *
- * @param matrixKey The matrix key to check.
- * @return True if the matrix key is already present, false otherwise.
+ * @param generation The generation to go back to.
+ * @return The generation restored: the latest one recorded up to `generation`, or -1 without an archive.
  */
-    bool Life::matrix_is_repeated(std::string matrixKey) {
-        auto result = m_allMatrixes.insert(matrixKey);
-        
-        return !result.second;
+    int Life::rewind(int generation) {
+        if(!m_archive){
+            return -1;
+        }
+        long restored = m_archive->restore(generation, *m_engine);
+        if(restored >= 0){
+            m_archive->truncate(restored);
+            m_cycles = make_cycle_detector(m_cycleOptions);
+            m_cycles->use_archive(m_archive.get());
+        }
+        return static_cast<int>(restored);
     }
 
 /**
@@ -321,10 +394,10 @@ bool file_exists(const std::string &str) {
  */
     void Life::print_matrix(int& genCount){
         std::cout << "Generation " << genCount << ":" << std::endl;
-        for(int ii = 1; ii < m_rows-1; ii++){
+        for(int ii = 0; ii < m_engine->rows(); ii++){
             std::cout << '[';
-            for(int jj = 1; jj < m_cols-1; jj++){
-                if(m_currentMatrix[ii][jj] == 2 || m_currentMatrix[ii][jj] == 0){
+            for(int jj = 0; jj < m_engine->cols(); jj++){
+                if(!m_engine->alive(ii, jj)){
                     std::cout << ' ';
                 }else{
                     std::cout << m_liveChar;
@@ -340,13 +413,40 @@ bool file_exists(const std::string &str) {
  *
  * This function runs the simulation loop, generating new generations and updating the matrix.
  * The loop terminates if a repeated pattern is detected, no live cells are present, or the maximum
- * number of generations is reached.
+ * number of generations is reached. The last board is then written to `output_rle` and
+ * `output_mc`, if set.
+ *
+ * With `checkpoint` set, the state is saved every `checkpoint_interval` generations,
+ * and on SIGTERM, which also stops the loop once the checkpoint is on disk.
  */
     void Life::simulation_loop(){
-        int genCount = 1;
+        int genCount = m_firstGeneration;
+        int lastCheckpoint = genCount;
+        if(m_checkpoints){
+            std::signal(SIGTERM, request_stop);
+        }
         while(true){
-            if(matrix_is_repeated(generate_matrix_key())){
-                return;
+            if(m_checkpoints){
+                bool stopping = stopRequested != 0;
+                if(stopping || (m_checkpointInterval > 0 && genCount - lastCheckpoint >= m_checkpointInterval)){
+                    save_checkpoint(genCount);
+                    lastCheckpoint = genCount;
+                }
+                if(stopping){
+                    if(m_frames){
+                        m_frames->flush();
+                    }
+                    m_checkpoints->flush();
+                    std::cout << ">>> Stopped at generation " << genCount << "; checkpoint written to "
+                              << m_checkpoints->path() << "." << std::endl;
+                    return;
+                }
+            }
+            if(m_archive){
+                m_archive->record(*m_engine, genCount);
+            }
+            if(matrix_is_repeated(genCount)){
+                break;
             }
             if(count_alive_cells() == 0){
                 break;
@@ -354,19 +454,33 @@ bool file_exists(const std::string &str) {
             if(m_maxGen > 0 && genCount > m_maxGen){
                 break;
             }
-            unsigned width = static_cast<unsigned int>(m_cols-2);
-            unsigned height = static_cast<unsigned int>(m_rows-2);
-            Canvas image(width, height, m_blockSize);
             int frame_duration_ms = 1000 / m_fps;
             std::this_thread::sleep_for(std::chrono::milliseconds(frame_duration_ms));
             if(m_image){
-                image.matrix_to_png(m_currentMatrix, m_aliveColor, m_bkgColor, m_imagePath, extractConfigPrefix(), genCount);
+                draw_frame(genCount);
             }else{
                 print_matrix(genCount);
             }
-            genCount++;
-            std::vector<std::vector<int>> newMatrix = generate_new_matrix();
-            m_currentMatrix = newMatrix;
+            // Engines that can jump ahead advance up to 2^m_jumpLog2 generations, and stop at
+            // max_gen + 1, the generation that ends the loop one step at a time too.
+            long generations = 1L << m_jumpLog2;
+            if(m_maxGen > 0){
+                generations = std::min<long>(generations, std::max(1L, static_cast<long>(m_maxGen) - genCount + 1));
+            }
+            genCount += static_cast<int>(m_engine->advance(generations));
+        }
+        if(m_frames){
+            m_frames->flush();
+        }
+        if(!m_rleOutput.empty()){
+            write_rle(m_rleOutput, *m_engine, m_gameRules);
+            std::cout << ">>> Last generation written to " << m_rleOutput << "." << std::endl;
+        }
+        if(!m_mcOutput.empty()){
+            write_macrocell_output();
+        }
+        if(m_archiveSeek > 0){
+            show_archived(m_archiveSeek);
         }
     }
 
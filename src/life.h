@@ -1,7 +1,7 @@
 #ifndef LIFE_H  // Correcting the include guard
 #define LIFE_H
 
-#include <set>
+#include <memory>
 #include <vector>
 #include <string>
 #include <stdexcept>
@@ -9,14 +9,36 @@
 #include <iostream>
 
 #include "data.h"
+#include "archive.h"
+#include "checkpoint.h"
+#include "dat_file.h"
+#include "frame_writer.h"
+#include "rle.h"
+#include "macrocell.h"
+#include "engine.h"
+#include "cycle.h"
 #include "../lib/canvas.h"
 #include "../lib/common.h"
 
 namespace life {
     class Life {
         private:
-            std::set<std::string> m_allMatrixes;
-            std::vector<std::vector<int>> m_currentMatrix;
+            std::unique_ptr<CycleDetector> m_cycles;
+            CycleOptions m_cycleOptions;
+            std::unique_ptr<StateArchive> m_archive;    //!< Past generations, when archive_interval is set.
+            long m_archiveInterval = 0;
+            int m_archiveSeek = 0;      //!< Generation shown from the archive once the run ends; zero for none.
+            int m_patternBorder = 10;   //!< Dead cells around a pattern read from an RLE or Macrocell file.
+            std::string m_rleOutput;    //!< Where the last board is written as RLE; empty for nowhere.
+            std::string m_mcOutput;     //!< Where the last board is written as Macrocell; empty for nowhere.
+            std::unique_ptr<CheckpointWriter> m_checkpoints;    //!< Writes `checkpoint`, when set.
+            long m_checkpointInterval = 0;  //!< Generations between two checkpoints; zero for on SIGTERM only.
+            std::string m_resumePath;       //!< Checkpoint the run goes on from, instead of input_cfg.
+            int m_firstGeneration = 1;
+            std::unique_ptr<Engine> m_engine;
+            std::string m_engineName = "bitgrid";
+            EngineOptions m_engineOptions;
+            int m_jumpLog2 = 0;     //!< Generations advanced per loop iteration, as a power of two.
 
             int m_rows;
             int m_cols;
@@ -30,6 +52,10 @@ namespace life {
             int m_blockSize = 10;
             std::string m_bkgColor = "RED";
             std::string m_imagePath;
+            bool m_palette = true;  //!< Frames are 1-bit palette PNGs rather than RGBA ones.
+            std::unique_ptr<FrameWriter> m_frames;  //!< Draws and encodes the images, made with the first one.
+            int m_imageThreads = 0;                 //!< Encoder threads; zero for one per core.
+            std::size_t m_imageQueue = 0;           //!< Frames that may wait for an encoder; zero for two per thread.
             int m_fps = 2;
             char m_liveChar = '*';
 
@@ -38,13 +64,6 @@ namespace life {
                 // Initialize member variables using the Data object
                 const auto& config = data.get_variablesAndValues();
 
-                if (config.find("input_cfg") != config.end()) {
-                    m_cfgFile = config.at("input_cfg");
-                    if(m_cfgFile.length() >=2 && m_cfgFile.front() == '"'  && m_cfgFile.back() == '"'){
-                        m_cfgFile = m_cfgFile.substr(1, m_cfgFile.length() - 2);
-                    }
-                    read_matrix_config(m_cfgFile);
-                }
                 if (config.find("generate_image") != config.end()) {
                     m_image = config.at("generate_image") == "true";
                 }
@@ -72,6 +91,15 @@ namespace life {
                         m_imagePath = m_imagePath.substr(1, m_imagePath.length() - 2);
                     }
                 }
+                if (config.find("palette") != config.end()) {
+                    m_palette = config.at("palette") == "true";
+                }
+                if (config.find("image_threads") != config.end()) {
+                    m_imageThreads = std::stoi(config.at("image_threads"));
+                }
+                if (config.find("image_queue") != config.end()) {
+                    m_imageQueue = std::stoul(config.at("image_queue"));
+                }
                 if (config.find("fps") != config.end()) {
                     m_fps = std::stoi(config.at("fps"));
                 }
@@ -82,24 +110,114 @@ namespace life {
                     }
                     set_conditions(m_gameRules);
                 }
-
-                m_currentMatrix.resize(m_rows, std::vector<int>(m_cols, 0));
+                if (config.find("engine") != config.end()) {
+                    m_engineName = config.at("engine");
+                }
+                if (config.find("kernel") != config.end()) {
+                    m_engineOptions.kernel = config.at("kernel");
+                }
+                if (config.find("hashlife_jump") != config.end()) {
+                    m_jumpLog2 = std::stoi(config.at("hashlife_jump"));
+                }
+                if (config.find("topology") != config.end()) {
+                    m_engineOptions.topology = config.at("topology");
+                }
+                if (config.find("threads") != config.end()) {
+                    m_engineOptions.threads = std::stoi(config.at("threads"));
+                }
+                if (config.find("cycle_detection") != config.end()) {
+                    m_cycleOptions.method = config.at("cycle_detection");
+                }
+                if (config.find("translated_cycles") != config.end()) {
+                    m_cycleOptions.translations = config.at("translated_cycles") == "true";
+                }
+                if (config.find("history_ram_mb") != config.end()) {
+                    m_cycleOptions.historyBytes = std::stoul(config.at("history_ram_mb")) << 20;
+                }
+                if (config.find("history_dir") != config.end()) {
+                    m_cycleOptions.historyDirectory = config.at("history_dir");
+                    if(m_cycleOptions.historyDirectory.length() >=2 && m_cycleOptions.historyDirectory.front() == '"'  && m_cycleOptions.historyDirectory.back() == '"'){
+                        m_cycleOptions.historyDirectory = m_cycleOptions.historyDirectory.substr(1, m_cycleOptions.historyDirectory.length() - 2);
+                    }
+                }
+                if (config.find("archive_interval") != config.end()) {
+                    m_archiveInterval = std::stol(config.at("archive_interval"));
+                }
+                if (config.find("archive_seek") != config.end()) {
+                    m_archiveSeek = std::stoi(config.at("archive_seek"));
+                }
+                if (config.find("pattern_border") != config.end()) {
+                    m_patternBorder = std::stoi(config.at("pattern_border"));
+                }
+                if (config.find("output_rle") != config.end()) {
+                    m_rleOutput = config.at("output_rle");
+                    if(m_rleOutput.length() >=2 && m_rleOutput.front() == '"'  && m_rleOutput.back() == '"'){
+                        m_rleOutput = m_rleOutput.substr(1, m_rleOutput.length() - 2);
+                    }
+                }
+                if (config.find("output_mc") != config.end()) {
+                    m_mcOutput = config.at("output_mc");
+                    if(m_mcOutput.length() >=2 && m_mcOutput.front() == '"'  && m_mcOutput.back() == '"'){
+                        m_mcOutput = m_mcOutput.substr(1, m_mcOutput.length() - 2);
+                    }
+                }
+                if (config.find("checkpoint") != config.end()) {
+                    std::string checkpointPath = config.at("checkpoint");
+                    if(checkpointPath.length() >=2 && checkpointPath.front() == '"'  && checkpointPath.back() == '"'){
+                        checkpointPath = checkpointPath.substr(1, checkpointPath.length() - 2);
+                    }
+                    if(!checkpointPath.empty()){
+                        m_checkpoints = std::make_unique<CheckpointWriter>(checkpointPath);
+                    }
+                }
+                if (config.find("checkpoint_interval") != config.end()) {
+                    m_checkpointInterval = std::stol(config.at("checkpoint_interval"));
+                }
+                if (config.find("resume") != config.end()) {
+                    m_resumePath = config.at("resume");
+                    if(m_resumePath.length() >=2 && m_resumePath.front() == '"'  && m_resumePath.back() == '"'){
+                        m_resumePath = m_resumePath.substr(1, m_resumePath.length() - 2);
+                    }
+                }
+                m_cycles = make_cycle_detector(m_cycleOptions);
+                if (m_archiveInterval > 0) {
+                    m_archive = std::make_unique<StateArchive>(m_archiveInterval);
+                }
+                m_cycles->use_archive(m_archive.get());
+                // The board is read last, once the engine and the rules are known.
+                if (config.find("input_cfg") != config.end()) {
+                    m_cfgFile = config.at("input_cfg");
+                    if(m_cfgFile.length() >=2 && m_cfgFile.front() == '"'  && m_cfgFile.back() == '"'){
+                        m_cfgFile = m_cfgFile.substr(1, m_cfgFile.length() - 2);
+                    }
+                    if(m_resumePath.empty()){
+                        read_matrix_config(m_cfgFile);
+                    }
+                }
+                if(!m_resumePath.empty()){
+                    read_checkpoint_config(m_resumePath);
+                }
             }
 
-            std::set<std::string> get_m_allMatrixes(){return m_allMatrixes;}
-            std::vector<std::vector<int>> get_m_currentMatrix(){return m_currentMatrix;}
+            const CycleDetector& get_cycles() const {return *m_cycles;}
+            const StateArchive* get_archive() const {return m_archive.get();}
+            const Engine& get_engine() const {return *m_engine;}
             int get_rows() {return m_rows;}
             int get_cols() {return m_cols;}
             void read_matrix_config(std::string path);
+            void read_rle_config(const std::string& path);
+            void read_macrocell_config(const std::string& path);
+            void write_macrocell_output() const;
+            void read_checkpoint_config(const std::string& path);
+            void save_checkpoint(int genCount);
             std::string extractConfigPrefix();
             void set_conditions(std::string input);
-            std::vector<std::pair<int, int>> find_dead_neighbors(int x, int y);
-            int count_live_neighbors(int x, int y);
-            void set_borders();
-            std::vector<std::vector<int>> generate_new_matrix();
+            Rule get_rule() const;
+            void draw_frame(int genCount);
             int count_alive_cells();
-            std::string generate_matrix_key();
-            bool matrix_is_repeated(std::string matrixKey);
+            bool matrix_is_repeated(int genCount);
+            int rewind(int generation);
+            void show_archived(int generation);
             void simulation_loop();
             void print_matrix(int& genCount);
     };
@@ -0,0 +1,156 @@
+#include <utility>
+
+#include "lut_engine.h"
+
+namespace life {
+
+    namespace {
+        /// Reads the four cells from column `col - 1` to `col + 2` of a padded row, leftmost in bit 0.
+        inline unsigned window4(const std::uint64_t* row, int col) {
+            const std::uint64_t* base = row - 1;    // Left padding word.
+            std::size_t position = static_cast<std::size_t>(col) - 1 + 64;
+            std::size_t word = position >> 6;
+            std::size_t shift = position & 63;
+            std::uint64_t bits = base[word] >> shift;
+            if(shift > 60){
+                bits |= base[word + 1] << (64 - shift);
+            }
+            return static_cast<unsigned>(bits & 15u);
+        }
+    }
+
+/**
+ * @brief Creates an empty board and builds the lookup table for the rule.
+ *
+ * @param rows Number of rows of the board.
+ * @param cols Number of columns of the board.
+ * @param rule Birth and survival conditions.
+ */
+    LutEngine::LutEngine(int rows, int cols, const Rule& rule)
+        : m_rows(rows), m_cols(cols) {
+        m_words = (static_cast<std::size_t>(cols) + 63) / 64;
+        m_stride = m_words + 2;
+        m_lastMask = (cols % 64 == 0) ? ~std::uint64_t{0} : ((std::uint64_t{1} << (cols % 64)) - 1);
+        m_cells.assign((static_cast<std::size_t>(rows) + 2) * m_stride, 0);
+        m_next.assign(m_cells.size(), 0);
+        build_table(rule);
+    }
+
+/**
+ * @brief Computes the next 2x2 center of every 4x4 neighborhood.
+ *
+ * Bit `4 * r + c` of the index is the cell in row `r` and column `c` of the
+ * neighborhood. Bit `2 * r + c` of the entry is the next state of the central
+ * cell in row `r + 1` and column `c + 1`.
+ */
+    void LutEngine::build_table(const Rule& rule) {
+        m_table.assign(1u << 16, 0);
+        for(unsigned index = 0; index < (1u << 16); index++){
+            std::uint8_t entry = 0;
+            for(int row = 1; row <= 2; row++){
+                for(int col = 1; col <= 2; col++){
+                    int count = 0;
+                    for(int dr = -1; dr <= 1; dr++){
+                        for(int dc = -1; dc <= 1; dc++){
+                            if(dr != 0 || dc != 0){
+                                count += (index >> (4 * (row + dr) + col + dc)) & 1u;
+                            }
+                        }
+                    }
+                    bool isAlive = (index >> (4 * row + col)) & 1u;
+                    std::uint16_t conditions = isAlive ? rule.survive : rule.born;
+                    if((conditions >> count) & 1u){
+                        entry |= static_cast<std::uint8_t>(1u << (2 * (row - 1) + (col - 1)));
+                    }
+                }
+            }
+            m_table[index] = entry;
+        }
+    }
+
+    bool LutEngine::alive(int row, int col) const {
+        return (row_ptr(m_cells, row)[col / 64] >> (col % 64)) & 1u;
+    }
+
+    void LutEngine::set(int row, int col, bool alive) {
+        std::uint64_t bit = std::uint64_t{1} << (col % 64);
+        std::uint64_t& word = row_ptr(m_cells, row)[col / 64];
+        std::uint64_t before = word;
+        word = alive ? (word | bit) : (word & ~bit);
+        m_hash ^= zobrist_row_delta(&before, &word, 1, (col / 64 + 1 == static_cast<int>(m_words)) ? m_lastMask : ~std::uint64_t{0},
+                                    row * m_words + col / 64);
+    }
+
+/**
+ * @brief Advances the board one generation, one 2x2 block per table lookup.
+ */
+    void LutEngine::step() {
+        for(int row = 0; row < m_rows; row += 2){
+            // With an odd number of rows, the last block's bottom row is the padding row,
+            // which must stay dead, and the row below it is outside the buffer: the
+            // padding row stands in for it too.
+            bool hasBottom = row + 1 < m_rows;
+            const std::uint64_t* neighborhood[4] = {row_ptr(m_cells, row - 1), row_ptr(m_cells, row),
+                                                    row_ptr(m_cells, row + 1),
+                                                    row_ptr(m_cells, hasBottom ? row + 2 : row + 1)};
+            std::uint64_t* top = row_ptr(m_next, row);
+            std::uint64_t* bottom = hasBottom ? row_ptr(m_next, row + 1) : nullptr;
+
+            std::uint64_t topWord = 0;
+            std::uint64_t bottomWord = 0;
+            for(int col = 0; col < m_cols; col += 2){
+                unsigned index = window4(neighborhood[0], col) | (window4(neighborhood[1], col) << 4)
+                               | (window4(neighborhood[2], col) << 8) | (window4(neighborhood[3], col) << 12);
+                unsigned entry = m_table[index];
+                int shift = col & 63;
+                topWord |= static_cast<std::uint64_t>(entry & 3u) << shift;
+                bottomWord |= static_cast<std::uint64_t>(entry >> 2) << shift;
+                if(shift == 62 || col + 2 >= m_cols){
+                    top[col / 64] = topWord;
+                    if(hasBottom){
+                        bottom[col / 64] = bottomWord;
+                    }
+                    topWord = 0;
+                    bottomWord = 0;
+                }
+            }
+            // Cells past the last column are outside the board and stay dead.
+            top[m_words - 1] &= m_lastMask;
+            if(hasBottom){
+                bottom[m_words - 1] &= m_lastMask;
+            }
+            for(int done = row; done < row + 2 && done < m_rows; done++){
+                m_hash ^= zobrist_row_delta(row_ptr(m_cells, done), row_ptr(m_next, done), m_words, m_lastMask, done * m_words);
+            }
+        }
+        std::swap(m_cells, m_next);
+    }
+
+    long LutEngine::population() const {
+        long count = 0;
+        for(std::uint64_t word : m_cells){
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
+
+    void LutEngine::pack(std::vector<std::uint64_t>& words) const {
+        words.resize(m_rows * m_words);
+        for(int row = 0; row < m_rows; row++){
+            const std::uint64_t* cells = row_ptr(m_cells, row);
+            std::copy(cells, cells + m_words, words.begin() + row * m_words);
+            words[(row + 1) * m_words - 1] &= m_lastMask;
+        }
+    }
+
+    void LutEngine::unpack(const std::vector<std::uint64_t>& words) {
+        for(int row = 0; row < m_rows; row++){
+            std::uint64_t* cells = row_ptr(m_cells, row);
+            const std::uint64_t* source = words.data() + row * m_words;
+            m_hash ^= zobrist_row_delta(cells, source, m_words, m_lastMask, row * m_words);
+            std::copy(source, source + m_words, cells);
+            cells[m_words - 1] &= m_lastMask;
+        }
+    }
+
+}
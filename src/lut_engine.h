@@ -0,0 +1,53 @@
+#ifndef LUT_ENGINE_H
+#define LUT_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "engine.h"
+
+namespace life {
+    //! Engine that advances 2x2 blocks of cells with a precomputed lookup table.
+    /*!
+     * The table has one entry for every 4x4 neighborhood (65536 of them), holding
+     * the next state of its central 2x2 block, and is built from the rule when the
+     * engine is created. A step then costs one lookup per four cells, for any rule.
+     *
+     * The board is bit-packed like in BitEngine: 64 cells per word, a dead padding
+     * word on each side of a row and a dead padding row above and below.
+     */
+    class LutEngine : public Engine {
+        private:
+            int m_rows;
+            int m_cols;
+            std::size_t m_words;
+            std::size_t m_stride;
+            std::uint64_t m_lastMask;
+            std::vector<std::uint8_t> m_table;     //!< Central 2x2 block, by 4x4 neighborhood.
+            std::vector<std::uint64_t> m_cells;
+            std::vector<std::uint64_t> m_next;
+            Hash128 m_hash;                         //!< Zobrist fingerprint of the board.
+
+            std::uint64_t* row_ptr(std::vector<std::uint64_t>& buffer, int row) {return buffer.data() + (row + 1) * m_stride + 1;}
+            const std::uint64_t* row_ptr(const std::vector<std::uint64_t>& buffer, int row) const {return buffer.data() + (row + 1) * m_stride + 1;}
+            void build_table(const Rule& rule);
+
+        public:
+            LutEngine(int rows, int cols, const Rule& rule);
+
+            int rows() const override {return m_rows;}
+            int cols() const override {return m_cols;}
+            bool alive(int row, int col) const override;
+            void set(int row, int col, bool alive) override;
+            void step() override;
+            long population() const override;
+            Hash128 state_hash() const override {return m_hash;}
+            ShapeHash shape_hash() const override {return packed_shape_hash(row_ptr(m_cells, 0), m_stride, m_rows, m_cols);}
+            void pack(std::vector<std::uint64_t>& words) const override;
+            void unpack(const std::vector<std::uint64_t>& words) override;
+            std::unique_ptr<Engine> clone() const override {return std::make_unique<LutEngine>(*this);}
+    };
+}
+
+#endif // LUT_ENGINE_H
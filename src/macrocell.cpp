@@ -0,0 +1,124 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "macrocell.h"
+#include "rle.h"
+
+namespace life {
+
+/**
+ * @brief Reads a Macrocell file one node per line.
+ *
+ * After the "[M2]" line and comments, where "#R" gives the rule, each line is a
+ * node: either an 8x8 leaf drawn with '.', '*' and '$' (end of row), or a
+ * "level nw ne sw se" line whose children are earlier lines, numbered from 1,
+ * or 0 for an empty square. Only two-state files are read.
+ *
+ * @param path File to read.
+ * @return The quadtree, as many nodes as the file has.
+ */
+    Macrocell read_macrocell(const std::string& path) {
+        std::ifstream file(path);
+        if(!file.is_open()){
+            std::cerr << ">>> Error opening the Macrocell file " << path << "!" << std::endl;
+            exit(1);
+        }
+
+        Macrocell tree;
+        std::string line;
+        if(!std::getline(file, line) || line.compare(0, 4, "[M2]") != 0){
+            std::cerr << ">>> " << path << " is not a Macrocell file!" << std::endl;
+            exit(1);
+        }
+        while(std::getline(file, line)){
+            if(line.empty() || line[0] == '\r'){
+                continue;
+            }
+            if(line[0] == '#'){
+                if(line.compare(0, 2, "#R") == 0){
+                    tree.rule = normalize_rule(line.substr(2));
+                    if(tree.rule.empty()){
+                        std::cerr << ">>> Unknown rule \"" << line.substr(2) << "\" in " << path << "!" << std::endl;
+                        exit(1);
+                    }
+                }
+                continue;
+            }
+
+            Macrocell::Node node;
+            if(line[0] == '.' || line[0] == '*' || line[0] == '$'){
+                int row = 0;
+                int col = 0;
+                for(char c : line){
+                    if(c == '$'){
+                        row++;
+                        col = 0;
+                    }else if(c == '.' || c == '*'){
+                        if(c == '*' && row < 8 && col < 8){
+                            node.cells |= std::uint64_t{1} << (8 * row + col);
+                        }
+                        col++;
+                    }
+                }
+            }else{
+                std::istringstream fields(line);
+                fields >> node.level >> node.children[0] >> node.children[1] >> node.children[2] >> node.children[3];
+                if(!fields || node.level < 4){
+                    std::cerr << ">>> Unsupported Macrocell node \"" << line << "\" in " << path << "!" << std::endl;
+                    exit(1);
+                }
+                for(std::size_t child : node.children){
+                    if(child > tree.nodes.size() || (child != 0 && tree.nodes[child - 1].level != node.level - 1)){
+                        std::cerr << ">>> Bad child " << child << " in node " << tree.nodes.size() + 1
+                                  << " of " << path << "!" << std::endl;
+                        exit(1);
+                    }
+                }
+            }
+            tree.nodes.push_back(node);
+        }
+        return tree;
+    }
+
+/**
+ * @brief Writes a quadtree as a Macrocell file, one line per node.
+ *
+ * Leaves leave out dead cells at the end of a row and empty rows at the end.
+ */
+    void write_macrocell(const std::string& path, const Macrocell& tree) {
+        std::ofstream file(path);
+        if(!file.is_open()){
+            std::cerr << ">>> Error creating the Macrocell file " << path << "!" << std::endl;
+            exit(1);
+        }
+
+        file << "[M2] (glife)\n";
+        if(!tree.rule.empty()){
+            file << "#R " << tree.rule << "\n";
+        }
+        for(const Macrocell::Node& node : tree.nodes){
+            if(node.level == 3){
+                std::string leaf;
+                for(int row = 0; row < 8; row++){
+                    unsigned cells = (node.cells >> (8 * row)) & 0xffu;
+                    for(int col = 0; cells != 0; col++, cells >>= 1){
+                        leaf += (cells & 1u) ? '*' : '.';
+                    }
+                    leaf += '$';
+                }
+                leaf.erase(leaf.find_last_not_of('$') + 1);
+                file << (leaf.empty() ? std::string("$") : leaf + "$") << "\n";
+            }else{
+                file << node.level << ' ' << node.children[0] << ' ' << node.children[1] << ' '
+                     << node.children[2] << ' ' << node.children[3] << "\n";
+            }
+        }
+        if(!file){
+            std::cerr << ">>> Error writing the Macrocell file " << path << "!" << std::endl;
+            exit(1);
+        }
+    }
+
+}
@@ -0,0 +1,38 @@
+#ifndef MACROCELL_H
+#define MACROCELL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace life {
+    //! Quadtree of a Macrocell (.mc) file: every distinct square of the pattern once.
+    struct Macrocell {
+        /// A square of 2^level x 2^level cells.
+        struct Node {
+            int level = 3;
+            std::uint64_t cells = 0;                    //!< Level 3: 8x8 cells, row `r` in bits 8r to 8r + 7.
+            std::size_t children[4] = {0, 0, 0, 0};     //!< Higher levels: nw, ne, sw, se, as 1-based node numbers; 0 for empty.
+        };
+
+        std::string rule;           //!< Rule as "B3/S23", or empty if the file has none.
+        std::vector<Node> nodes;    //!< Children come before their parents; the last node is the root.
+    };
+
+    /**
+     * @brief Reads a two-state Macrocell file.
+     *
+     * @param path File to read.
+     */
+    Macrocell read_macrocell(const std::string& path);
+    /**
+     * @brief Writes a quadtree as a Macrocell file.
+     *
+     * @param path File to write.
+     * @param tree Quadtree to write; its rule goes to the "#R" line.
+     */
+    void write_macrocell(const std::string& path, const Macrocell& tree);
+}
+
+#endif // MACROCELL_H
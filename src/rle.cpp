@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include "rle.h"
+
+namespace life {
+
+    namespace {
+        using File = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+        std::string trim(const std::string& text) {
+            std::size_t first = text.find_first_not_of(" \t\r");
+            std::size_t last = text.find_last_not_of(" \t\r");
+            return (first == std::string::npos) ? "" : text.substr(first, last - first + 1);
+        }
+
+        /// Sets cells [from, to) of a packed row, a word at a time.
+        void fill_cells(std::uint64_t* row, std::size_t from, std::size_t to) {
+            while(from < to){
+                std::size_t bit = from % 64;
+                std::size_t count = std::min<std::size_t>(64 - bit, to - from);
+                std::uint64_t mask = (count == 64) ? ~std::uint64_t{0} : ((std::uint64_t{1} << count) - 1);
+                row[from / 64] |= mask << bit;
+                from += count;
+            }
+        }
+
+        /// First column from `from` on whose cell is `alive`, or `cols` if there is none.
+        int next_cell(const std::uint64_t* row, int from, int cols, bool alive) {
+            std::size_t words = words_per_row(cols);
+            for(std::size_t k = from / 64; k < words; k++){
+                std::uint64_t word = alive ? row[k] : ~row[k];
+                if(k == static_cast<std::size_t>(from / 64)){
+                    word &= ~std::uint64_t{0} << (from % 64);
+                }
+                if(word != 0){
+                    return std::min(cols, static_cast<int>(64 * k) + __builtin_ctzll(word));
+                }
+            }
+            return cols;
+        }
+    }
+
+/**
+ * @brief Converts a rule to the "B3/S23" notation used by the configuration file.
+ *
+ * Accepts "B3/S23" in either order and case, and the older "23/3" notation,
+ * survival first. A topology suffix such as ":T100,100" is ignored.
+ *
+ * @param rule Rule as written in an RLE header.
+ * @return The rule as "B3/S23", or an empty string if it cannot be read.
+ */
+    std::string normalize_rule(const std::string& rule) {
+        std::string text = trim(rule.substr(0, rule.find(':')));
+        std::size_t slash = text.find('/');
+        if(slash == std::string::npos){
+            return "";
+        }
+        std::string parts[2] = {trim(text.substr(0, slash)), trim(text.substr(slash + 1))};
+        std::string born;
+        std::string survive;
+        for(int index = 0; index < 2; index++){
+            std::string digits = parts[index];
+            char letter = digits.empty() ? '\0' : static_cast<char>(std::toupper(digits[0]));
+            if(letter == 'B' || letter == 'S'){
+                digits = digits.substr(1);
+            }else if(std::isalpha(static_cast<unsigned char>(letter))){
+                return "";
+            }else{
+                letter = (index == 0) ? 'S' : 'B';
+            }
+            for(char digit : digits){
+                if(digit < '0' || digit > '8'){
+                    return "";
+                }
+            }
+            (letter == 'B' ? born : survive) = digits;
+        }
+        return "B" + born + "/S" + survive;
+    }
+
+/**
+ * @brief Reads an RLE file straight into a packed board.
+ *
+ * The file is read in blocks and decoded one character at a time: runs of live
+ * cells are set a word at a time in the board, so no line or row is copied.
+ * Lines starting with '#' before the header are comments; the header gives the
+ * size of the pattern and, optionally, its rule. Reading stops at '!'. Cells
+ * past the size given by the header are ignored.
+ *
+ * @param path File to read.
+ * @param border Dead cells added on each side of the pattern.
+ * @return The board, `border` cells larger than the pattern on each side.
+ */
+    RlePattern read_rle(const std::string& path, int border) {
+        File file(std::fopen(path.c_str(), "rb"), &std::fclose);
+        if(!file){
+            std::cerr << ">>> Error opening the RLE file " << path << "!" << std::endl;
+            exit(1);
+        }
+
+        RlePattern pattern;
+        std::string header;
+        bool inHeader = true;
+        bool lineStart = true;
+        bool comment = false;
+        std::size_t stride = 0;
+        std::uint64_t count = 0;
+        long row = 0;
+        std::uint64_t col = 0;
+        std::vector<char> buffer(1 << 16);
+        std::size_t size;
+        bool done = false;
+        while(!done && (size = std::fread(buffer.data(), 1, buffer.size(), file.get())) > 0){
+            for(std::size_t index = 0; index < size && !done; index++){
+                char c = buffer[index];
+                if(inHeader){
+                    if(c == '\n'){
+                        lineStart = true;
+                        comment = false;
+                    }else if(lineStart && c == '#'){
+                        comment = true;
+                        lineStart = false;
+                    }else if(!comment){
+                        lineStart = false;
+                        header += c;
+                    }
+                    if(c != '\n' || trim(header).empty()){
+                        continue;
+                    }
+
+                    // The header is "x = 3, y = 3, rule = B3/S23".
+                    int width = -1;
+                    int height = -1;
+                    std::size_t start = 0;
+                    while(start <= header.size()){
+                        std::size_t end = header.find(',', start);
+                        end = (end == std::string::npos) ? header.size() : end;
+                        std::string item = header.substr(start, end - start);
+                        std::size_t equal = item.find('=');
+                        if(equal != std::string::npos){
+                            std::string key = trim(item.substr(0, equal));
+                            std::string value = trim(item.substr(equal + 1));
+                            if(key == "x"){
+                                width = std::atoi(value.c_str());
+                            }else if(key == "y"){
+                                height = std::atoi(value.c_str());
+                            }else if(key == "rule"){
+                                pattern.rule = normalize_rule(value);
+                                if(pattern.rule.empty()){
+                                    std::cerr << ">>> Unknown rule \"" << value << "\" in " << path << "!" << std::endl;
+                                    exit(1);
+                                }
+                            }
+                        }
+                        start = end + 1;
+                    }
+                    if(width <= 0 || height <= 0){
+                        std::cerr << ">>> Missing pattern size in the header of " << path << "!" << std::endl;
+                        exit(1);
+                    }
+                    pattern.rows = height + 2 * border;
+                    pattern.cols = width + 2 * border;
+                    stride = words_per_row(pattern.cols);
+                    pattern.cells.assign(pattern.rows * stride, 0);
+                    inHeader = false;
+                    continue;
+                }
+
+                if(c >= '0' && c <= '9'){
+                    count = count * 10 + static_cast<std::uint64_t>(c - '0');
+                    continue;
+                }
+                std::uint64_t run = (count == 0) ? 1 : count;
+                count = 0;
+                if(c == 'b' || c == '.'){
+                    col += run;
+                }else if(c == 'o' || (c >= 'A' && c <= 'X')){
+                    std::uint64_t width = pattern.cols - 2 * border;
+                    if(row < pattern.rows - 2 * border && col < width){
+                        std::uint64_t* cells = pattern.cells.data() + (row + border) * stride;
+                        fill_cells(cells, border + col, border + std::min(col + run, width));
+                    }
+                    col += run;
+                }else if(c == '$'){
+                    row += static_cast<long>(run);
+                    col = 0;
+                }else if(c == '!'){
+                    done = true;
+                }else if(!std::isspace(static_cast<unsigned char>(c))){
+                    std::cerr << ">>> Unexpected character '" << c << "' in " << path << "!" << std::endl;
+                    exit(1);
+                }
+            }
+        }
+        if(inHeader){
+            std::cerr << ">>> Missing header in " << path << "!" << std::endl;
+            exit(1);
+        }
+        return pattern;
+    }
+
+/**
+ * @brief Writes a board as RLE, a run at a time.
+ *
+ * Runs are found a word at a time in the packed board. Dead cells at the end of
+ * a row and empty rows at the end of the board are left out, empty rows in
+ * between are folded into the count of the '$' that ends the row, and lines are
+ * kept under 70 characters, as the format asks.
+ *
+ * @param path File to write.
+ * @param engine Engine holding the board.
+ * @param rule Rule written to the header, as "B3/S23".
+ */
+    void write_rle(const std::string& path, const Engine& engine, const std::string& rule) {
+        File file(std::fopen(path.c_str(), "wb"), &std::fclose);
+        if(!file){
+            std::cerr << ">>> Error creating the RLE file " << path << "!" << std::endl;
+            exit(1);
+        }
+
+        std::vector<std::uint64_t> cells;
+        engine.pack(cells);
+        std::size_t stride = words_per_row(engine.cols());
+        std::string out = "x = " + std::to_string(engine.cols()) + ", y = " + std::to_string(engine.rows())
+                        + ", rule = " + rule + "\n";
+        std::size_t lineStart = out.size();
+        auto put = [&](long run, char tag){
+            std::string token = (run > 1) ? std::to_string(run) + tag : std::string(1, tag);
+            if(out.size() - lineStart + token.size() > 70){
+                out += '\n';
+                lineStart = out.size();
+            }
+            out += token;
+        };
+
+        long rowsToEnd = 0;     // '$' still to be written before the next live cell.
+        for(int row = 0; row < engine.rows(); row++){
+            const std::uint64_t* rowCells = cells.data() + row * stride;
+            int col = next_cell(rowCells, 0, engine.cols(), true);
+            if(col < engine.cols()){
+                if(rowsToEnd > 0){
+                    put(rowsToEnd, '$');
+                    rowsToEnd = 0;
+                }
+                int end = 0;
+                while(col < engine.cols()){
+                    if(col > end){
+                        put(col - end, 'b');
+                    }
+                    end = next_cell(rowCells, col, engine.cols(), false);
+                    put(end - col, 'o');
+                    col = next_cell(rowCells, end, engine.cols(), true);
+                }
+            }
+            rowsToEnd++;
+        }
+        out += "!\n";
+        if(std::fwrite(out.data(), 1, out.size(), file.get()) != out.size()){
+            std::cerr << ">>> Error writing the RLE file " << path << "!" << std::endl;
+            exit(1);
+        }
+    }
+
+}
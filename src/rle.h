@@ -0,0 +1,38 @@
+#ifndef RLE_H
+#define RLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+
+namespace life {
+    /// Board read from an RLE file.
+    struct RlePattern {
+        int rows = 0;
+        int cols = 0;
+        std::string rule;                   //!< Rule of the header as "B3/S23", or empty if it has none.
+        std::vector<std::uint64_t> cells;   //!< Board packed like Engine::pack().
+    };
+
+    /**
+     * @brief Reads a pattern in run-length encoded (RLE) format.
+     *
+     * @param path File to read.
+     * @param border Dead cells added on each side of the pattern.
+     */
+    RlePattern read_rle(const std::string& path, int border = 0);
+    /**
+     * @brief Writes the board of an engine in run-length encoded (RLE) format.
+     *
+     * @param path File to write.
+     * @param engine Engine holding the board.
+     * @param rule Rule written to the header, as "B3/S23".
+     */
+    void write_rle(const std::string& path, const Engine& engine, const std::string& rule);
+    /// Rule in B/S or S/B notation, in either case, written as "B3/S23"; empty if it is not a rule.
+    std::string normalize_rule(const std::string& rule);
+}
+
+#endif // RLE_H
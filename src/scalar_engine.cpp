@@ -0,0 +1,162 @@
+#include <utility>
+
+#include "scalar_engine.h"
+
+namespace life {
+
+    namespace {
+        /// Offsets of the eight neighbors of a cell.
+        constexpr int directions[8][2] = {
+            {-1, -1}, {-1, 0}, {-1, 1},
+            { 0, -1},          { 0, 1},
+            { 1, -1}, { 1, 0}, { 1, 1}
+        };
+    }
+
+/**
+ * @brief Zobrist key of a word of the current matrix (see zobrist_key()).
+ *
+ * @param row The row of the board, without the border.
+ * @param word The word of the row.
+ */
+    Hash128 ScalarEngine::word_hash(int row, int word) const {
+        std::uint64_t cells = 0;
+        for(int col = 64 * word; col < 64 * word + 64 && col < m_cols - 2; col++){
+            cells |= static_cast<std::uint64_t>(alive(row, col)) << (col % 64);
+        }
+        return zobrist_key(row * words_per_row(m_cols - 2) + word, cells);
+    }
+
+    void ScalarEngine::set(int row, int col, bool alive){
+        m_hash ^= word_hash(row, col / 64);
+        m_currentMatrix[index(row + 1, col + 1)] = alive ? 1 : 0;
+        m_hash ^= word_hash(row, col / 64);
+    }
+
+/**
+ * @brief Marks the dead neighbors of a cell as border cells.
+ *
+ * This function marks with 2 the dead neighbors of the cell at the specified row and column.
+ *
+ * @param row The row index of the cell.
+ * @param col The column index of the cell.
+ */
+    void ScalarEngine::mark_dead_neighbors(int row, int col){
+        for(const auto& dir : directions){
+            int& neighbor = m_currentMatrix[index(row + dir[0], col + dir[1])];
+            if(neighbor == 0){
+                neighbor = 2;
+            }
+        }
+    }
+
+/**
+ * @brief Counts the live neighbors of a cell.
+ *
+ * This function counts the live neighbors of a cell at the specified row and column.
+ *
+ * @param row The row index of the cell.
+ * @param col The column index of the cell.
+ * @return The number of live neighbors.
+ */
+    int ScalarEngine::count_live_neighbors(int row, int col) const {
+        int count = 0;
+        for(const auto& dir : directions){
+            if(m_currentMatrix[index(row + dir[0], col + dir[1])] == 1){
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+/**
+ * @brief Sets the borders cells. A cell is considered a border cell when it is a dead neighbor of a live cell.
+ *
+ * This function sets the borders cells by marking the dead neighbors of live cells.
+ */
+    void ScalarEngine::set_borders(){
+        for(int ii = 1; ii < m_rows -1; ii++){
+            for(int jj = 1; jj < m_cols-1; jj++){
+                if(m_currentMatrix[index(ii, jj)] == 1){
+                    mark_dead_neighbors(ii, jj);
+                }
+            }
+        }
+    }
+
+/**
+ * @brief Generates the next generation into the back buffer.
+ *
+ * This function writes every cell of the next generation into the back buffer, based
+ * on the current matrix and the birth and survival conditions. Border cells that are
+ * not born stay marked as border cells.
+ */
+    void ScalarEngine::generate_new_matrix(){
+        set_borders();
+        std::size_t words = words_per_row(m_cols - 2);
+        for(int ii = 1; ii < m_rows-1; ii++){
+            std::uint64_t currentWord = 0;
+            std::uint64_t nextWord = 0;
+            for(int jj = 1; jj < m_cols-1; jj++){
+                int current = m_currentMatrix[index(ii, jj)];
+                int next = current;
+                if(current == 1){
+                    int aliveNeighbors = count_live_neighbors(ii, jj);
+                    bool willSurvive = (m_rule.survive >> aliveNeighbors) & 1u;
+                    if(!willSurvive){
+                        next = 0;
+                    }
+                }
+                if(current == 2){
+                    int aliveNeighbors = count_live_neighbors(ii, jj);
+                    if((m_rule.born >> aliveNeighbors) & 1u){
+                        next = 1;
+                    }
+                }
+                m_nextMatrix[index(ii, jj)] = next;
+
+                // The fingerprint is updated one word of 64 cells at a time.
+                int bit = (jj - 1) % 64;
+                currentWord |= static_cast<std::uint64_t>(current == 1) << bit;
+                nextWord |= static_cast<std::uint64_t>(next == 1) << bit;
+                if(bit == 63 || jj == m_cols - 2){
+                    if(currentWord != nextWord){
+                        std::size_t word = (ii - 1) * words + (jj - 1) / 64;
+                        m_hash ^= zobrist_key(word, currentWord);
+                        m_hash ^= zobrist_key(word, nextWord);
+                    }
+                    currentWord = 0;
+                    nextWord = 0;
+                }
+            }
+        }
+    }
+
+/**
+ * @brief Advances the board one generation and swaps the buffers.
+ */
+    void ScalarEngine::step(){
+        generate_new_matrix();
+        std::swap(m_currentMatrix, m_nextMatrix);
+    }
+
+/**
+ * @brief Counts the number of alive cells in the current matrix.
+ *
+ * This function counts the number of alive cells (cells with value 1) in the current matrix.
+ *
+ * @return The number of alive cells.
+ */
+    long ScalarEngine::population() const {
+        long count = 0;
+        for (int value : m_currentMatrix) {
+            if(value == 1){
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+}
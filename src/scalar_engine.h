@@ -0,0 +1,53 @@
+#ifndef SCALAR_ENGINE_H
+#define SCALAR_ENGINE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "engine.h"
+
+namespace life {
+    //! Reference engine that evaluates one cell at a time.
+    /*!
+     * The matrix keeps a one-cell dead border around the board. Value 1 is a live
+     * cell, 0 a dead cell and 2 a dead cell that neighbors a live one (a candidate
+     * for birth).
+     *
+     * The matrix is a flat row-major buffer, and the next generation is written to
+     * a second preallocated buffer; the two are swapped after each step, so stepping
+     * allocates nothing.
+     */
+    class ScalarEngine : public Engine {
+        private:
+            std::vector<int> m_currentMatrix;
+            std::vector<int> m_nextMatrix;
+            int m_rows;
+            int m_cols;
+            Rule m_rule;
+            Hash128 m_hash;     //!< Zobrist fingerprint of the board.
+
+            std::size_t index(int row, int col) const {return static_cast<std::size_t>(row) * m_cols + col;}
+            Hash128 word_hash(int row, int word) const;
+
+        public:
+            ScalarEngine(int rows, int cols, const Rule& rule)
+                : m_currentMatrix(static_cast<std::size_t>(rows + 2) * (cols + 2), 0), m_nextMatrix(m_currentMatrix.size(), 0),
+                  m_rows(rows + 2), m_cols(cols + 2), m_rule(rule) {}
+
+            int rows() const override {return m_rows - 2;}
+            int cols() const override {return m_cols - 2;}
+            bool alive(int row, int col) const override {return m_currentMatrix[index(row + 1, col + 1)] == 1;}
+            void set(int row, int col, bool alive) override;
+            void step() override;
+            long population() const override;
+            Hash128 state_hash() const override {return m_hash;}
+            std::unique_ptr<Engine> clone() const override {return std::make_unique<ScalarEngine>(*this);}
+
+            void mark_dead_neighbors(int x, int y);
+            int count_live_neighbors(int x, int y) const;
+            void set_borders();
+            void generate_new_matrix();
+    };
+}
+
+#endif // SCALAR_ENGINE_H
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <vector>
+
+#include "state_hash.h"
+
+namespace life {
+
+    namespace {
+        /// Live cells of a board moved to a box starting at (0, 0), bit-packed like the board.
+        struct Box {
+            int rows = 0;
+            int cols = 0;
+            std::size_t stride = 0;
+            std::vector<std::uint64_t> cells;
+            int top = 0;
+            int left = 0;
+
+            Box() = default;
+            Box(int boxRows, int boxCols) : rows(boxRows), cols(boxCols), stride(words_per_row(boxCols)),
+                                            cells(boxRows * stride, 0) {}
+            std::uint64_t* row(int index) {return cells.data() + index * stride;}
+            const std::uint64_t* row(int index) const {return cells.data() + index * stride;}
+        };
+
+        /**
+         * @brief Copies the bounding box of the live cells of a bit-packed board.
+         *
+         * @return False if the board is empty.
+         */
+        bool bounding_box(const std::uint64_t* cells, std::size_t stride, int rows, int cols, Box& box) {
+            std::size_t words = words_per_row(cols);
+            std::uint64_t lastMask = (cols % 64 == 0) ? ~std::uint64_t{0} : ((std::uint64_t{1} << (cols % 64)) - 1);
+            auto word = [&](int row, std::size_t k){
+                std::uint64_t value = cells[row * stride + k];
+                return (k + 1 == words) ? (value & lastMask) : value;
+            };
+
+            int top = -1;
+            int bottom = -1;
+            long left = cols;
+            long right = -1;
+            for(int row = 0; row < rows; row++){
+                for(std::size_t k = 0; k < words; k++){
+                    std::uint64_t value = word(row, k);
+                    if(value != 0){
+                        top = (top < 0) ? row : top;
+                        bottom = row;
+                        left = std::min(left, static_cast<long>(64 * k) + __builtin_ctzll(value));
+                        right = std::max(right, static_cast<long>(64 * k) + 63 - __builtin_clzll(value));
+                    }
+                }
+            }
+            if(top < 0){
+                return false;
+            }
+
+            box = Box(bottom - top + 1, static_cast<int>(right - left + 1));
+            box.top = top;
+            box.left = static_cast<int>(left);
+            std::size_t shift = left % 64;
+            for(int row = top; row <= bottom; row++){
+                std::uint64_t* out = box.row(row - top);
+                for(std::size_t k = 0; k < box.stride; k++){
+                    std::size_t source = left / 64 + k;
+                    std::uint64_t value = (source < words) ? word(row, source) >> shift : 0;
+                    if(shift != 0 && source + 1 < words){
+                        value |= word(row, source + 1) << (64 - shift);
+                    }
+                    out[k] = value;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Fingerprint of a box as a board of its own size, its rows taken bottom to top if `upsideDown`.
+         *
+         * Words are numbered by the stride of the box, so boxes of different shapes
+         * could number the same cells alike; the size of the box is hashed in too,
+         * under a word index no board reaches.
+         */
+        Hash128 box_hash(const Box& box, bool upsideDown) {
+            Hash128 hash = zobrist_key(~std::uint64_t{0}, (static_cast<std::uint64_t>(box.rows) << 32)
+                                                          | static_cast<std::uint32_t>(box.cols));
+            for(int row = 0; row < box.rows; row++){
+                const std::uint64_t* cells = box.row(upsideDown ? box.rows - 1 - row : row);
+                for(std::size_t k = 0; k < box.stride; k++){
+                    hash ^= zobrist_key(row * box.stride + k, cells[k]);
+                }
+            }
+            return hash;
+        }
+
+        std::uint64_t reverse_bits(std::uint64_t x) {
+            x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+            x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+            x = ((x >> 4) & 0x0f0f0f0f0f0f0f0full) | ((x & 0x0f0f0f0f0f0f0f0full) << 4);
+            return __builtin_bswap64(x);
+        }
+
+        /// Box reflected left to right: each row reversed a word at a time, then moved back to column 0.
+        Box mirror(const Box& box) {
+            Box out(box.rows, box.cols);
+            std::size_t pad = out.stride * 64 - box.cols;
+            std::vector<std::uint64_t> reversed(box.stride);
+            for(int row = 0; row < box.rows; row++){
+                const std::uint64_t* cells = box.row(row);
+                for(std::size_t k = 0; k < box.stride; k++){
+                    reversed[k] = reverse_bits(cells[box.stride - 1 - k]);
+                }
+                std::uint64_t* target = out.row(row);
+                for(std::size_t k = 0; k < box.stride; k++){
+                    target[k] = reversed[k] >> pad;
+                    if(pad != 0 && k + 1 < box.stride){
+                        target[k] |= reversed[k + 1] << (64 - pad);
+                    }
+                }
+            }
+            return out;
+        }
+
+        /**
+         * @brief Transposes a 64x64 block of cells in place: bit `c` of word `r` swaps with bit `r` of word `c`.
+         *
+         * The two off-diagonal halves are swapped with shifts and masks, then the
+         * quarters of each half, and so on, so the block takes 6 rounds of 32
+         * word operations instead of 4096 single-cell moves.
+         */
+        void transpose64(std::uint64_t block[64]) {
+            std::uint64_t mask = 0x00000000ffffffffull;
+            for(int width = 32; width != 0; width >>= 1, mask ^= mask << width){
+                for(int k = 0; k < 64; k = ((k | width) + 1) & ~width){
+                    std::uint64_t swap = ((block[k] >> width) ^ block[k | width]) & mask;
+                    block[k] ^= swap << width;
+                    block[k | width] ^= swap;
+                }
+            }
+        }
+
+        /// Box reflected along its main diagonal, 64x64 blocks at a time.
+        Box transpose(const Box& box) {
+            Box out(box.cols, box.rows);
+            std::uint64_t block[64];
+            for(int rowBlock = 0; rowBlock < box.rows; rowBlock += 64){
+                for(std::size_t k = 0; k < box.stride; k++){
+                    for(int r = 0; r < 64; r++){
+                        block[r] = (rowBlock + r < box.rows) ? box.row(rowBlock + r)[k] : 0;
+                    }
+                    transpose64(block);
+                    for(int c = 0; c < 64 && static_cast<int>(64 * k) + c < box.cols; c++){
+                        out.row(static_cast<int>(64 * k) + c)[rowBlock / 64] = block[c];
+                    }
+                }
+            }
+            return out;
+        }
+    }
+
+/**
+ * @brief Fingerprints the live cells of a bit-packed board relative to their bounding box.
+ *
+ * The cells are moved so that the box starts at (0, 0) and hashed like a board as
+ * wide as the box, so a pattern has the same fingerprint wherever it is. This costs
+ * one pass over the words of the board to find the box, and one over the box.
+ *
+ * @param cells First word of the first row.
+ * @param stride Words between the start of two rows.
+ * @param rows Number of rows of the board.
+ * @param cols Number of columns of the board; bits past the last column are ignored.
+ * @return The fingerprint and the top-left corner of the box; an empty board has a zero fingerprint.
+ */
+    ShapeHash packed_shape_hash(const std::uint64_t* cells, std::size_t stride, int rows, int cols) {
+        ShapeHash shape;
+        Box box;
+        if(!bounding_box(cells, stride, rows, cols, box)){
+            return shape;
+        }
+        shape.hash = box_hash(box, false);
+        shape.top = box.top;
+        shape.left = box.left;
+        return shape;
+    }
+
+/**
+ * @brief Fingerprints the live cells of a bit-packed board whatever their position and orientation.
+ *
+ * The bounding box is fingerprinted like packed_shape_hash() in each of the 8
+ * rotations and reflections of the square, and the smallest fingerprint is kept.
+ * Turning the box upside down only changes the order its rows are hashed in, so
+ * only a mirrored, a transposed and a transposed and mirrored copy are built,
+ * a word at a time.
+ *
+ * @param cells First word of the first row.
+ * @param stride Words between the start of two rows.
+ * @param rows Number of rows of the board.
+ * @param cols Number of columns of the board; bits past the last column are ignored.
+ * @return The fingerprint; an empty board has a zero fingerprint.
+ */
+    Hash128 packed_canonical_hash(const std::uint64_t* cells, std::size_t stride, int rows, int cols) {
+        Box box;
+        if(!bounding_box(cells, stride, rows, cols, box)){
+            return Hash128();
+        }
+        Box transposed = transpose(box);
+        const Box orientations[] = {mirror(box), transposed, mirror(transposed)};
+
+        Hash128 canonical = box_hash(box, false);
+        auto keep_smallest = [&canonical](const Hash128& hash){
+            if(hash.high < canonical.high || (hash.high == canonical.high && hash.low < canonical.low)){
+                canonical = hash;
+            }
+        };
+        keep_smallest(box_hash(box, true));
+        for(const Box& oriented : orientations){
+            keep_smallest(box_hash(oriented, false));
+            keep_smallest(box_hash(oriented, true));
+        }
+        return canonical;
+    }
+
+}
@@ -0,0 +1,87 @@
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace life {
+    /// 128-bit fingerprint of a board.
+    struct Hash128 {
+        std::uint64_t low = 0;
+        std::uint64_t high = 0;
+
+        bool operator==(const Hash128& other) const {return low == other.low && high == other.high;}
+        bool operator!=(const Hash128& other) const {return !(*this == other);}
+        Hash128& operator^=(const Hash128& other) {
+            low ^= other.low;
+            high ^= other.high;
+            return *this;
+        }
+    };
+
+    /// MurmurHash3 64-bit finalizer: every input bit affects every output bit.
+    inline std::uint64_t fmix64(std::uint64_t x) {
+        x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdull;
+        x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53ull;
+        return x ^ (x >> 33);
+    }
+
+    /**
+     * @brief Zobrist key of the 64 cells of a board word.
+     *
+     * Rows are split in words of 64 cells, bit `j` of word `k` being column
+     * 64k + j, and words are numbered `row * words_per_row(cols) + k`. The
+     * fingerprint of a board is the XOR of the keys of its words, so when a step
+     * changes a word, the fingerprint is updated with the keys of its old and new
+     * values, whatever the number of cells that changed in it. An empty word has a
+     * zero key, so only words with live cells count.
+     *
+     * @param word Index of the word on the board.
+     * @param cells Cells of the word.
+     */
+    inline Hash128 zobrist_key(std::uint64_t word, std::uint64_t cells) {
+        // Branch-free, since whether a word is empty is unpredictable on busy boards.
+        std::uint64_t live = ~std::uint64_t{0} * (cells != 0);
+        return Hash128{fmix64(cells ^ (word * 0x9e3779b97f4a7c15ull)) & live,
+                       fmix64(cells ^ (word * 0xd6e8feb86659fd93ull) ^ 0x5851f42d4c957f2dull) & live};
+    }
+
+    /// Fingerprint of the live cells relative to their bounding box, and where the box is.
+    struct ShapeHash {
+        Hash128 hash;       //!< Zobrist fingerprint of the cells, as if the box started at (0, 0).
+        int top = 0;        //!< First row with a live cell.
+        int left = 0;       //!< First column with a live cell.
+    };
+
+    /// Number of words holding a row of `cols` cells.
+    inline std::size_t words_per_row(int cols) {return (static_cast<std::size_t>(cols) + 63) / 64;}
+
+    /**
+     * @brief Change of the fingerprint between two versions of a bit-packed row.
+     *
+     * @param before Cells of the row before the step.
+     * @param after Cells of the row after the step.
+     * @param words Words holding the cells of the row.
+     * @param lastMask Valid bits of the last word.
+     * @param firstWord Index of the first word of the row.
+     */
+    inline Hash128 zobrist_row_delta(const std::uint64_t* before, const std::uint64_t* after, std::size_t words,
+                                     std::uint64_t lastMask, std::uint64_t firstWord) {
+        Hash128 delta;
+        for(std::size_t k = 0; k < words; k++){
+            std::uint64_t mask = (k + 1 == words) ? lastMask : ~std::uint64_t{0};
+            std::uint64_t old = before[k] & mask;
+            std::uint64_t now = after[k] & mask;
+            if(old != now){
+                delta ^= zobrist_key(firstWord + k, old);
+                delta ^= zobrist_key(firstWord + k, now);
+            }
+        }
+        return delta;
+    }
+
+    ShapeHash packed_shape_hash(const std::uint64_t* cells, std::size_t stride, int rows, int cols);
+    Hash128 packed_canonical_hash(const std::uint64_t* cells, std::size_t stride, int rows, int cols);
+}
+
+#endif // STATE_HASH_H
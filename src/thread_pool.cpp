@@ -0,0 +1,109 @@
+#include "thread_pool.h"
+
+namespace life {
+
+/**
+ * @brief Starts the worker threads.
+ *
+ * @param threads Number of threads working on each batch, counting the caller.
+ *                Zero or less uses one thread per hardware core.
+ */
+    ThreadPool::ThreadPool(int threads) {
+        if(threads <= 0){
+            threads = static_cast<int>(std::thread::hardware_concurrency());
+        }
+        for(int ii = 1; ii < threads; ii++){
+            m_workers.emplace_back(&ThreadPool::worker_loop, this);
+        }
+    }
+
+/**
+ * @brief Stops and joins the worker threads.
+ */
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for(auto& worker : m_workers){
+            worker.join();
+        }
+    }
+
+/**
+ * @brief Takes tasks of the current batch until none is left.
+ */
+    void ThreadPool::run_tasks(TaskFunction function, void* context) {
+        while(true){
+            int index;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(m_nextTask >= m_tasks){
+                    return;
+                }
+                index = m_nextTask++;
+            }
+            function(context, index);
+        }
+    }
+
+/**
+ * @brief Body of a worker thread: waits for a batch, works on it and reports back.
+ */
+    void ThreadPool::worker_loop() {
+        long seenBatch = 0;
+        while(true){
+            TaskFunction function;
+            void* context;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&]{ return m_stop || m_batch != seenBatch; });
+                if(m_stop){
+                    return;
+                }
+                seenBatch = m_batch;
+                function = m_function;
+                context = m_context;
+            }
+            run_tasks(function, context);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(--m_busyWorkers == 0){
+                    m_done.notify_one();
+                }
+            }
+        }
+    }
+
+/**
+ * @brief Runs a batch of tasks on the workers and the calling thread.
+ *
+ * @param tasks Number of tasks in the batch.
+ * @param function Called once with every task index.
+ * @param context Passed unchanged to `function`.
+ */
+    void ThreadPool::run(int tasks, TaskFunction function, void* context) {
+        if(m_workers.empty()){
+            for(int index = 0; index < tasks; index++){
+                function(context, index);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_function = function;
+            m_context = context;
+            m_tasks = tasks;
+            m_nextTask = 0;
+            m_busyWorkers = static_cast<int>(m_workers.size());
+            m_batch++;
+        }
+        m_wake.notify_all();
+        run_tasks(function, context);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&]{ return m_busyWorkers == 0; });
+    }
+
+}
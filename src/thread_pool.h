@@ -0,0 +1,55 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace life {
+    //! Fixed set of worker threads that run batches of indexed tasks.
+    /*!
+     * The threads are created once and sleep between batches, so a batch costs a
+     * wake-up instead of a thread creation. The calling thread also works on the
+     * batch, so a pool of size N has N - 1 workers.
+     */
+    class ThreadPool {
+        private:
+            using TaskFunction = void (*)(void* context, int index);
+
+            std::vector<std::thread> m_workers;
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            std::condition_variable m_done;
+            TaskFunction m_function = nullptr;
+            void* m_context = nullptr;
+            int m_tasks = 0;
+            int m_nextTask = 0;
+            int m_busyWorkers = 0;
+            long m_batch = 0;
+            bool m_stop = false;
+
+            void worker_loop();
+            void run_tasks(TaskFunction function, void* context);
+            void run(int tasks, TaskFunction function, void* context);
+
+        public:
+            explicit ThreadPool(int threads);
+            ~ThreadPool();
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /// Number of threads working on a batch, counting the caller.
+            int size() const {return static_cast<int>(m_workers.size()) + 1;}
+
+            /// Runs `task(index)` for every index in [0, tasks) and waits for all of them.
+            template <typename F>
+            void parallel_for(int tasks, F&& task) {
+                using Task = std::remove_reference_t<F>;
+                run(tasks, [](void* context, int index){ (*static_cast<Task*>(context))(index); }, &task);
+            }
+    };
+}
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <utility>
+
+#include "tile_engine.h"
+#include "bit_kernel.h"
+
+namespace life {
+
+/**
+ * @brief Creates an empty universe.
+ *
+ * @param rows Rows of the window shown from the universe.
+ * @param cols Columns of the window shown from the universe.
+ * @param rule Birth and survival conditions. Births with zero neighbors (B0) are
+ *             not supported, since they would fill the whole universe.
+ */
+    TileEngine::TileEngine(int rows, int cols, const Rule& rule)
+        : m_rows(rows), m_cols(cols), m_rule(rule) {
+        if(rule.born & 1u){
+            std::cerr << ">>> The tiles engine does not support births with zero neighbors (B0)!" << std::endl;
+            exit(1);
+        }
+    }
+
+/**
+ * @brief Copies the tiles and the fingerprint, but not the spare map nodes.
+ */
+    TileEngine::TileEngine(const TileEngine& other)
+        : Engine(other), m_rows(other.m_rows), m_cols(other.m_cols), m_rule(other.m_rule),
+          m_tiles(other.m_tiles), m_hash(other.m_hash) {
+    }
+
+/**
+ * @brief Returns the tile at the given tile coordinates, or an empty tile if it is not stored.
+ */
+    const TileEngine::Tile& TileEngine::tile_at(std::int32_t tileRow, std::int32_t tileCol) const {
+        static const Tile emptyTile{};
+        auto found = m_tiles.find(key(tileRow, tileCol));
+        return found == m_tiles.end() ? emptyTile : found->second;
+    }
+
+    bool TileEngine::alive(int row, int col) const {
+        // Arithmetic shifts round towards minus infinity, so negative coordinates work too.
+        const Tile& tile = tile_at(row >> 6, col >> 6);
+        return (tile[row & 63] >> (col & 63)) & 1u;
+    }
+
+    void TileEngine::set(int row, int col, bool alive) {
+        std::uint64_t tileKey = key(row >> 6, col >> 6);
+        std::uint64_t bit = std::uint64_t{1} << (col & 63);
+        auto found = m_tiles.find(tileKey);
+        std::uint64_t before = (found == m_tiles.end()) ? 0 : found->second[row & 63];
+        std::uint64_t after = alive ? before | bit : before & ~bit;
+        if(after == before){
+            return;
+        }
+        if(found == m_tiles.end()){
+            found = m_tiles.emplace(tileKey, Tile{}).first;
+        }
+        found->second[row & 63] = after;
+        if(row >= 0 && row < m_rows && col >= 0 && col < m_cols){
+            std::size_t words = words_per_row(m_cols);
+            std::uint64_t mask = (static_cast<std::size_t>(col >> 6) + 1 == words && m_cols % 64 != 0)
+                               ? (std::uint64_t{1} << (m_cols % 64)) - 1 : ~std::uint64_t{0};
+            m_hash ^= zobrist_row_delta(&before, &after, 1, mask, static_cast<std::uint64_t>(row) * words + (col >> 6));
+        }
+    }
+
+/**
+ * @brief Copies the window into packed words; cells outside it are left out.
+ */
+    void TileEngine::pack(std::vector<std::uint64_t>& words) const {
+        std::size_t stride = words_per_row(m_cols);
+        words.assign(m_rows * stride, 0);
+        std::uint64_t lastMask = (m_cols % 64 != 0) ? (std::uint64_t{1} << (m_cols % 64)) - 1 : ~std::uint64_t{0};
+        for(const auto& [tileKey, tile] : m_tiles){
+            std::int32_t tileRow = key_row(tileKey);
+            std::int32_t tileCol = key_col(tileKey);
+            if(tileRow < 0 || tileCol < 0 || static_cast<std::size_t>(tileCol) >= stride){
+                continue;
+            }
+            std::uint64_t mask = (static_cast<std::size_t>(tileCol) + 1 == stride) ? lastMask : ~std::uint64_t{0};
+            long firstRow = static_cast<long>(tileRow) * tile_size;
+            for(long row = 0; row < tile_size && firstRow + row < m_rows; row++){
+                words[(firstRow + row) * stride + tileCol] = tile[row] & mask;
+            }
+        }
+    }
+
+/**
+ * @brief Replaces the whole universe with the window in packed words.
+ *
+ * Each word of the window is one row of a tile, so the words are copied as
+ * they are, and the fingerprint is computed once from the words with live cells.
+ */
+    void TileEngine::unpack(const std::vector<std::uint64_t>& words) {
+        spare_tiles(m_tiles);
+        m_hash = Hash128();
+        std::size_t stride = words_per_row(m_cols);
+        std::uint64_t lastMask = (m_cols % 64 != 0) ? (std::uint64_t{1} << (m_cols % 64)) - 1 : ~std::uint64_t{0};
+        for(int row = 0; row < m_rows; row++){
+            for(std::size_t word = 0; word < stride; word++){
+                std::uint64_t cells = words[row * stride + word] & ((word + 1 == stride) ? lastMask : ~std::uint64_t{0});
+                if(cells == 0){
+                    continue;
+                }
+                std::uint64_t tileKey = key(row >> 6, static_cast<std::int32_t>(word));
+                auto found = m_tiles.find(tileKey);
+                if(found == m_tiles.end()){
+                    found = m_tiles.emplace(tileKey, Tile{}).first;
+                }
+                found->second[row & 63] = cells;
+                m_hash ^= zobrist_key(row * stride + word, cells);
+            }
+        }
+    }
+
+/**
+ * @brief Takes every node out of a map and keeps it for the next tiles.
+ */
+    void TileEngine::spare_tiles(TileMap& tiles) {
+        while(!tiles.empty()){
+            m_spare.push_back(tiles.extract(tiles.begin()));
+        }
+    }
+
+/**
+ * @brief Computes the next generation of one tile.
+ *
+ * @param tileRow,tileCol Tile coordinates.
+ * @param next Receives the new tile.
+ * @return True if the new tile has any live cell.
+ */
+    bool TileEngine::step_tile(std::int32_t tileRow, std::int32_t tileCol, Tile& next) const {
+        const Tile* around[3][3];
+        for(int dr = -1; dr <= 1; dr++){
+            for(int dc = -1; dc <= 1; dc++){
+                around[dr + 1][dc + 1] = &tile_at(tileRow + dr, tileCol + dc);
+            }
+        }
+
+        // Word of row `row` (from -1 to 64) in the tile column `dc`, looking through the tiles above and below.
+        auto word = [&around](int row, int dc){
+            if(row < 0){
+                return (*around[0][dc])[tile_size - 1];
+            }
+            if(row >= tile_size){
+                return (*around[2][dc])[0];
+            }
+            return (*around[1][dc])[row];
+        };
+
+        std::uint64_t any = 0;
+        for(int row = 0; row < tile_size; row++){
+            next[row] = step_word(word(row - 1, 0), word(row - 1, 1), word(row - 1, 2),
+                                  word(row, 0), word(row, 1), word(row, 2),
+                                  word(row + 1, 0), word(row + 1, 1), word(row + 1, 2), m_rule);
+            any |= next[row];
+        }
+        return any != 0;
+    }
+
+/**
+ * @brief Change of the window's fingerprint between two versions of a tile.
+ *
+ * The window starts at (0, 0), so each row of a tile inside it is one word of the fingerprint.
+ *
+ * @param tileRow,tileCol Tile coordinates.
+ * @param before Tile before the step.
+ * @param after Tile after the step.
+ */
+    Hash128 TileEngine::window_delta(std::int32_t tileRow, std::int32_t tileCol, const Tile& before, const Tile& after) const {
+        Hash128 delta;
+        std::size_t words = words_per_row(m_cols);
+        if(tileRow < 0 || tileCol < 0 || static_cast<std::size_t>(tileCol) >= words){
+            return delta;
+        }
+        std::uint64_t mask = (static_cast<std::size_t>(tileCol) + 1 == words && m_cols % 64 != 0)
+                           ? (std::uint64_t{1} << (m_cols % 64)) - 1 : ~std::uint64_t{0};
+        long firstRow = static_cast<long>(tileRow) * tile_size;
+        for(long row = 0; row < tile_size && firstRow + row < m_rows; row++){
+            delta ^= zobrist_row_delta(&before[row], &after[row], 1, mask, (firstRow + row) * words + tileCol);
+        }
+        return delta;
+    }
+
+/**
+ * @brief Advances the universe one generation.
+ *
+ * The tiles computed are the stored ones and the neighbors reached by live cells
+ * on their edges. Tiles that end up empty are dropped.
+ */
+    void TileEngine::step() {
+        m_candidates.clear();
+        for(const auto& [tileKey, tile] : m_tiles){
+            std::int32_t tileRow = key_row(tileKey);
+            std::int32_t tileCol = key_col(tileKey);
+            std::uint64_t leftEdge = 0;
+            std::uint64_t rightEdge = 0;
+            for(std::uint64_t word : tile){
+                leftEdge |= word & 1u;
+                rightEdge |= word >> 63;
+            }
+            bool top = tile[0] != 0;
+            bool bottom = tile[tile_size - 1] != 0;
+
+            m_candidates.push_back(tileKey);
+            if(top){
+                m_candidates.push_back(key(tileRow - 1, tileCol));
+            }
+            if(bottom){
+                m_candidates.push_back(key(tileRow + 1, tileCol));
+            }
+            if(leftEdge){
+                m_candidates.push_back(key(tileRow, tileCol - 1));
+            }
+            if(rightEdge){
+                m_candidates.push_back(key(tileRow, tileCol + 1));
+            }
+            if(tile[0] & 1u){
+                m_candidates.push_back(key(tileRow - 1, tileCol - 1));
+            }
+            if(tile[0] >> 63){
+                m_candidates.push_back(key(tileRow - 1, tileCol + 1));
+            }
+            if(tile[tile_size - 1] & 1u){
+                m_candidates.push_back(key(tileRow + 1, tileCol - 1));
+            }
+            if(tile[tile_size - 1] >> 63){
+                m_candidates.push_back(key(tileRow + 1, tileCol + 1));
+            }
+        }
+        std::sort(m_candidates.begin(), m_candidates.end());
+        m_candidates.erase(std::unique(m_candidates.begin(), m_candidates.end()), m_candidates.end());
+
+        // The tiles of the generation before are computed in place of their map nodes.
+        spare_tiles(m_next);
+        for(std::uint64_t tileKey : m_candidates){
+            if(m_spare.empty()){
+                m_spare.push_back(m_next.extract(m_next.emplace(tileKey, Tile{}).first));
+            }
+            TileMap::node_type& node = m_spare.back();
+            bool live = step_tile(key_row(tileKey), key_col(tileKey), node.mapped());
+            m_hash ^= window_delta(key_row(tileKey), key_col(tileKey), tile_at(key_row(tileKey), key_col(tileKey)), node.mapped());
+            if(live){
+                node.key() = tileKey;
+                m_next.insert(std::move(node));
+                m_spare.pop_back();
+            }
+        }
+        std::swap(m_tiles, m_next);
+    }
+
+    long TileEngine::population() const {
+        long count = 0;
+        for(const auto& entry : m_tiles){
+            for(std::uint64_t word : entry.second){
+                count += __builtin_popcountll(word);
+            }
+        }
+        return count;
+    }
+
+}
@@ -0,0 +1,75 @@
+#ifndef TILE_ENGINE_H
+#define TILE_ENGINE_H
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "engine.h"
+
+namespace life {
+    //! Engine for an unbounded universe stored as a hash map of 64x64 bit tiles.
+    /*!
+     * Only tiles holding live cells are stored. A step computes every stored tile
+     * plus the neighbor tiles that live cells on a tile edge can reach, and drops
+     * the tiles that end up empty, so memory and step time follow the live area.
+     *
+     * The board size read from the input file is only the window shown and saved;
+     * patterns leaving it keep evolving outside, and negative coordinates are valid.
+     * The fingerprint only covers the window, like the cells shown.
+     *
+     * The map nodes of the tiles dropped by a step are kept and filled by the
+     * next one, so a step whose number of tiles does not grow allocates nothing.
+     */
+    class TileEngine : public Engine {
+        public:
+            static constexpr int tile_size = 64;
+            /// One row per word, bit `j` of a word is column `j` of the tile.
+            using Tile = std::array<std::uint64_t, tile_size>;
+
+        private:
+            using TileMap = std::unordered_map<std::uint64_t, Tile>;
+
+            int m_rows;
+            int m_cols;
+            Rule m_rule;
+            TileMap m_tiles;
+            TileMap m_next;
+            std::vector<TileMap::node_type> m_spare;    //!< Map nodes of dropped tiles, to fill again.
+            std::vector<std::uint64_t> m_candidates;
+            Hash128 m_hash;                         //!< Zobrist fingerprint of the window.
+
+            static std::uint64_t key(std::int32_t tileRow, std::int32_t tileCol) {
+                return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(tileRow)) << 32) | static_cast<std::uint32_t>(tileCol);
+            }
+            static std::int32_t key_row(std::uint64_t key) {return static_cast<std::int32_t>(key >> 32);}
+            static std::int32_t key_col(std::uint64_t key) {return static_cast<std::int32_t>(key & 0xFFFFFFFFu);}
+
+            const Tile& tile_at(std::int32_t tileRow, std::int32_t tileCol) const;
+            bool step_tile(std::int32_t tileRow, std::int32_t tileCol, Tile& next) const;
+            Hash128 window_delta(std::int32_t tileRow, std::int32_t tileCol, const Tile& before, const Tile& after) const;
+            void spare_tiles(TileMap& tiles);
+
+        public:
+            TileEngine(int rows, int cols, const Rule& rule);
+            TileEngine(const TileEngine& other);
+            TileEngine& operator=(const TileEngine&) = delete;
+
+            int rows() const override {return m_rows;}
+            int cols() const override {return m_cols;}
+            bool alive(int row, int col) const override;
+            void set(int row, int col, bool alive) override;
+            void step() override;
+            long population() const override;
+            Hash128 state_hash() const override {return m_hash;}
+            void pack(std::vector<std::uint64_t>& words) const override;
+            void unpack(const std::vector<std::uint64_t>& words) override;
+            std::unique_ptr<Engine> clone() const override {return std::make_unique<TileEngine>(*this);}
+
+            /// Number of tiles currently stored.
+            std::size_t tile_count() const {return m_tiles.size();}
+    };
+}
+
+#endif // TILE_ENGINE_H